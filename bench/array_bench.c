@@ -0,0 +1,59 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench_utilities.h"
+
+#define OPERATIONS 2000000
+#define MAX_SIZE 4096
+
+/**
+ * Measures how many operations a second a scalar priority queue of a given size performs with each backend. The
+ * queue is filled up to its size, and every operation then removes the first element and inserts a new one, so the
+ * size stays the same. PQ_BACKEND_LIST is the layout the other backends are compared against.
+ */
+
+static const PQBackend backends[] = {PQ_BACKEND_LIST, PQ_BACKEND_HEAP, PQ_BACKEND_ARRAY};
+
+/**
+ * benchOperations: Fills the queue with size elements and replaces its first element OPERATIONS times
+ * @return
+ *      the amount of operations per second, or -1 if the queue couldn't be filled
+ */
+static double benchOperations(PriorityQueue queue, int size) {
+    srand(size);
+    for (int i = 0; i < size; i++) {
+        PQScalarPriority priority = rand();
+        if (pqInsert(queue, &i, &priority) != PQ_SUCCESS) {
+            return -1;
+        }
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < OPERATIONS; i++) {
+        PQScalarPriority priority = rand();
+        pqRemove(queue);
+        if (pqInsert(queue, &i, &priority) != PQ_SUCCESS) {
+            return -1;
+        }
+    }
+    return OPERATIONS / secondsSince(&start);
+}
+
+int main() {
+    printf("size,list_operations_per_second,heap_operations_per_second,array_operations_per_second\n");
+    for (int size = 16; size <= MAX_SIZE; size = size * 4) {
+        printf("%d", size);
+        for (int i = 0; i < (int) (sizeof(backends) / sizeof(*backends)); i++) {
+            PriorityQueue queue = pqCreateScalar(backends[i], copyInt, freeInt, equalInts, NULL);
+            if (queue == NULL) {
+                return 1;
+            }
+            printf(",%.0f", benchOperations(queue, size));
+            pqDestroy(queue);
+        }
+        printf("\n");
+    }
+    return 0;
+}
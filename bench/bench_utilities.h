@@ -0,0 +1,45 @@
+#ifndef BENCH_UTILITIES_H_
+#define BENCH_UTILITIES_H_
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../priority_queue.h"
+
+/**
+ * Functions shared by the benchmarks. The elements are ints, and so are the priorities of the queues that have
+ * priority functions, where a lower value is a higher priority. A benchmark includes this header after defining
+ * _POSIX_C_SOURCE, which clock_gettime needs.
+ */
+
+static inline PQElement copyInt(PQElement element) {
+    int *copy = malloc(sizeof(*copy));
+    if (copy == NULL) {
+        return NULL;
+    }
+    *copy = *(int *) element;
+    return copy;
+}
+
+static inline void freeInt(PQElement element) {
+    free(element);
+}
+
+static inline bool equalInts(PQElement first, PQElement second) {
+    return *(int *) first == *(int *) second;
+}
+
+static inline int compareInts(PQElementPriority first, PQElementPriority second) {
+    return *(int *) second - *(int *) first;
+}
+
+/**
+ * secondsSince: Retrieve the seconds that passed since start, which was read from CLOCK_MONOTONIC
+ */
+static inline double secondsSince(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double) (end.tv_sec - start->tv_sec) + (double) (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+#endif /* BENCH_UTILITIES_H_ */
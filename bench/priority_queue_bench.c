@@ -0,0 +1,371 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench_utilities.h"
+
+#define DEFAULT_MIN_SIZE 1000
+#define DEFAULT_MAX_SIZE 10000000
+#define SIZE_FACTOR 10
+#define LOOKUPS 100
+#define LINEAR_MAX_SIZE 10000
+
+/**
+ * Measures the time every workload takes on a priority queue of a given size, for every backend, and prints one CSV
+ * line per workload, backend and size with the nanoseconds per operation, the operations per second and the peak
+ * resident memory of the run.
+ *
+ * Usage: priority_queue_bench [min_size [max_size [backend [workload]]]]
+ * The sizes go from min_size up to max_size, multiplied by SIZE_FACTOR each time. backend and workload are names
+ * from the tables below, or "all". Every run happens in a child process of its own, so its peak memory is its own
+ * and not the largest of the runs before it.
+ *
+ * The list and the heap are measured both with priority functions and with scalar priorities, the other backends
+ * only exist for scalar queues. A lower value is a higher priority in both cases, and the elements are ids whose
+ * current priorities the benchmark keeps, so the workloads can insert relative to the first element as an event
+ * queue does. The list and the array move an element to its place in O(n), by scanning the list or moving the
+ * array, so the workloads that do size such updates are skipped on them above LINEAR_MAX_SIZE, their time grows as
+ * the square of the size.
+ */
+
+typedef struct {
+    const char *name;
+    PQBackend backend;
+    bool scalar;
+    bool linear_updates;
+} BenchQueue;
+
+typedef struct {
+    const char *name;
+    bool updates;
+    double (*run)(PriorityQueue queue, int size, int *operations);
+} BenchWorkload;
+
+static PQScalarPriority *priorities;
+static PQHandle *handles;
+static unsigned long random_state = 88172645463325252UL;
+
+static PQElementPriority copyPriority(PQElementPriority priority) {
+    PQScalarPriority *copy = malloc(sizeof(*copy));
+    if (copy == NULL) {
+        return NULL;
+    }
+    *copy = *(PQScalarPriority *) priority;
+    return copy;
+}
+
+static void freePriority(PQElementPriority priority) {
+    free(priority);
+}
+
+static int comparePriorities(PQElementPriority first, PQElementPriority second) {
+    PQScalarPriority first_value = *(PQScalarPriority *) first, second_value = *(PQScalarPriority *) second;
+    if (first_value == second_value) {
+        return 0;
+    }
+    return first_value < second_value ? 1 : -1;
+}
+
+/**
+ * benchRandom: Returns a pseudo-random number from a xorshift generator, the same sequence on every run
+ */
+static unsigned long benchRandom(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+/**
+ * benchFill: Inserts the ids 0 to size - 1 with increasing priorities, keeping a handle to each of them
+ * @return
+ *      false if an insert failed
+ *      true otherwise
+ */
+static bool benchFill(PriorityQueue queue, int size) {
+    for (int i = 0; i < size; i++) {
+        priorities[i] = i;
+        if (pqInsertWithHandle(queue, &i, &priorities[i], &handles[i]) != PQ_SUCCESS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * benchInsert: Inserts size ids with random priorities into an empty queue
+ */
+static double benchInsert(PriorityQueue queue, int size, int *operations) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < size; i++) {
+        priorities[i] = (PQScalarPriority) (benchRandom() % (unsigned long) size);
+        if (pqInsert(queue, &i, &priorities[i]) != PQ_SUCCESS) {
+            return -1;
+        }
+    }
+    *operations = size;
+    return secondsSince(&start);
+}
+
+/**
+ * benchMix: Removes the first element of a full queue and inserts it again with a later priority, size times, so the
+ * size stays the same. Each removal and each insert is an operation
+ */
+static double benchMix(PriorityQueue queue, int size, int *operations) {
+    if (benchFill(queue, size) == false) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < size; i++) {
+        PQElement first;
+        if (pqPeekTopK(queue, 1, &first) != 1) {
+            return -1;
+        }
+        int id = *(int *) first;
+        PQScalarPriority priority = priorities[id] + (PQScalarPriority) (benchRandom() % (unsigned long) size);
+        pqRemove(queue);
+        priorities[id] = priority;
+        if (pqInsert(queue, &id, &priorities[id]) != PQ_SUCCESS) {
+            return -1;
+        }
+    }
+    *operations = size * 2;
+    return secondsSince(&start);
+}
+
+/**
+ * benchContains: Looks for LOOKUPS ids in a full queue, half of which are in it
+ */
+static double benchContains(PriorityQueue queue, int size, int *operations) {
+    if (benchFill(queue, size) == false) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < LOOKUPS; i++) {
+        int id = (int) (benchRandom() % (unsigned long) size) + (i % 2) * size;
+        pqContains(queue, &id);
+    }
+    *operations = LOOKUPS;
+    return secondsSince(&start);
+}
+
+/**
+ * benchChangePriority: Gives LOOKUPS random elements of a full queue random priorities with pqChangePriority, which
+ * finds each element by its value and old priority as the event manager does
+ */
+static double benchChangePriority(PriorityQueue queue, int size, int *operations) {
+    if (benchFill(queue, size) == false) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < LOOKUPS; i++) {
+        int id = (int) (benchRandom() % (unsigned long) size);
+        PQScalarPriority priority = (PQScalarPriority) (benchRandom() % (unsigned long) size);
+        if (pqChangePriority(queue, &id, &priorities[id], &priority) != PQ_SUCCESS) {
+            return -1;
+        }
+        priorities[id] = priority;
+    }
+    *operations = LOOKUPS;
+    return secondsSince(&start);
+}
+
+/**
+ * benchChangePriorityByHandle: Gives size random elements of a full queue random priorities, through their handles
+ */
+static double benchChangePriorityByHandle(PriorityQueue queue, int size, int *operations) {
+    if (benchFill(queue, size) == false) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < size; i++) {
+        int id = (int) (benchRandom() % (unsigned long) size);
+        priorities[id] = (PQScalarPriority) (benchRandom() % (unsigned long) size);
+        if (pqChangePriorityByHandle(queue, handles[id], &priorities[id]) != PQ_SUCCESS) {
+            return -1;
+        }
+    }
+    *operations = size;
+    return secondsSince(&start);
+}
+
+/**
+ * benchIterate: Walks all the elements of a full queue in order with an external iterator, each element is an
+ * operation
+ */
+static double benchIterate(PriorityQueue queue, int size, int *operations) {
+    if (benchFill(queue, size) == false) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    PQIterator iterator = pqIteratorCreate(queue);
+    if (iterator == NULL) {
+        return -1;
+    }
+    int count = 0;
+    for (PQElement element = pqIteratorFirst(iterator); element != NULL; element = pqIteratorNext(iterator)) {
+        count = count + 1;
+    }
+    pqIteratorDestroy(iterator);
+    *operations = count;
+    return secondsSince(&start);
+}
+
+/**
+ * benchCopyDestroy: Copies a full queue, inserts one element into the copy and destroys it. pqCopy only shares the
+ * entries of the queue, the insert is what makes the copy copy every element and priority, so it is timed along with
+ * pqCopy, and the queue is checked to still hold its own entries afterwards. Each element is an operation
+ */
+static double benchCopyDestroy(PriorityQueue queue, int size, int *operations) {
+    if (benchFill(queue, size) == false) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    PriorityQueue copy = pqCopy(queue);
+    if (copy == NULL || pqInsert(copy, &size, &priorities[0]) != PQ_SUCCESS || pqGetSize(copy) != size + 1) {
+        pqDestroy(copy);
+        return -1;
+    }
+    pqDestroy(copy);
+    double seconds = secondsSince(&start);
+    if (pqGetSize(queue) != size || pqContains(queue, &size)) {
+        return -1;
+    }
+    *operations = size;
+    return seconds;
+}
+
+static const BenchQueue queues[] = {
+        {"list",         PQ_BACKEND_LIST,  false, true},
+        {"heap",         PQ_BACKEND_HEAP,  false, false},
+        {"scalar_list",  PQ_BACKEND_LIST,  true,  true},
+        {"scalar_heap",  PQ_BACKEND_HEAP,  true,  false},
+        {"scalar_radix", PQ_BACKEND_RADIX, true,  false},
+        {"scalar_wheel", PQ_BACKEND_WHEEL, true,  false},
+        {"scalar_array", PQ_BACKEND_ARRAY, true,  true}
+};
+
+static const BenchWorkload workloads[] = {
+        {"insert",          true,  benchInsert},
+        {"insert_remove",   true,  benchMix},
+        {"contains",        false, benchContains},
+        {"change_priority", false, benchChangePriority},
+        {"change_handle",   true,  benchChangePriorityByHandle},
+        {"iterate",         false, benchIterate},
+        {"copy_destroy",    false, benchCopyDestroy}
+};
+
+static PriorityQueue benchCreate(const BenchQueue *queue) {
+    if (queue->scalar) {
+        return pqCreateScalar(queue->backend, copyInt, freeInt, equalInts, NULL);
+    }
+    return pqCreateWithBackend(queue->backend, copyInt, freeInt, equalInts, copyPriority, freePriority,
+                               comparePriorities);
+}
+
+/**
+ * peakMemory: Retrieve the peak resident memory of the calling process in kilobytes
+ */
+static long peakMemory(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss;
+}
+
+static bool selected(const char *filter, const char *name) {
+    return strcmp(filter, "all") == 0 || strcmp(filter, name) == 0;
+}
+
+/**
+ * benchRun: Runs a workload on a new queue of one backend and prints its CSV line, in the child process it is called
+ * from, so the peak memory printed is that of this run alone
+ * @return
+ *      the exit status of the child, 0 if the workload ran
+ */
+static int benchRun(const BenchWorkload *workload, const BenchQueue *bench_queue, int size) {
+    priorities = malloc(sizeof(*priorities) * (size + 1));
+    handles = malloc(sizeof(*handles) * size);
+    PriorityQueue queue = benchCreate(bench_queue);
+    if (priorities == NULL || handles == NULL || queue == NULL) {
+        return 1;
+    }
+    int operations = 0;
+    double seconds = workload->run(queue, size, &operations);
+    pqDestroy(queue);
+    if (seconds < 0) {
+        fprintf(stderr, "%s on %s failed at size %d\n", workload->name, bench_queue->name, size);
+        return 1;
+    }
+    printf("%s,%s,%d,%d,%.1f,%.0f,%ld\n", workload->name, bench_queue->name, size, operations,
+           seconds * 1e9 / operations, operations / seconds, peakMemory());
+    free(priorities);
+    free(handles);
+    return 0;
+}
+
+/**
+ * benchRunInChild: Runs benchRun in a child process and waits for it
+ * @return
+ *      false if the child couldn't be started or failed
+ *      true otherwise
+ */
+static bool benchRunInChild(const BenchWorkload *workload, const BenchQueue *bench_queue, int size) {
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0) {
+        return false;
+    }
+    if (child == 0) {
+        int status = benchRun(workload, bench_queue, size);
+        fflush(stdout);
+        _exit(status);
+    }
+    int status;
+    if (waitpid(child, &status, 0) != child) {
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv) {
+    int min_size = argc > 1 ? atoi(argv[1]) : DEFAULT_MIN_SIZE;
+    int max_size = argc > 2 ? atoi(argv[2]) : DEFAULT_MAX_SIZE;
+    const char *backend_filter = argc > 3 ? argv[3] : "all";
+    const char *workload_filter = argc > 4 ? argv[4] : "all";
+    if (min_size <= 0 || max_size < min_size) {
+        fprintf(stderr, "usage: %s [min_size [max_size [backend [workload]]]]\n", argv[0]);
+        return 1;
+    }
+    printf("workload,backend,size,operations,ns_per_operation,operations_per_second,peak_rss_kb\n");
+    for (long size = min_size; size <= max_size; size = size * SIZE_FACTOR) {
+        for (int w = 0; w < (int) (sizeof(workloads) / sizeof(*workloads)); w++) {
+            if (selected(workload_filter, workloads[w].name) == false) {
+                continue;
+            }
+            for (int q = 0; q < (int) (sizeof(queues) / sizeof(*queues)); q++) {
+                if (selected(backend_filter, queues[q].name) == false ||
+                    (workloads[w].updates && queues[q].linear_updates && size > LINEAR_MAX_SIZE)) {
+                    continue;
+                }
+                if (benchRunInChild(&workloads[w], &queues[q], (int) size) == false) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
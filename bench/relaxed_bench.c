@@ -0,0 +1,78 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench_utilities.h"
+
+#define ELEMENTS 1000000
+#define MAX_THREADS 16
+#define SUB_QUEUES_PER_THREAD 4
+
+/**
+ * Measures how many elements a second all threads together remove from a relaxed priority queue and from a
+ * concurrent one, for 1, 2, 4... up to MAX_THREADS threads. Both queues are filled with the same ELEMENTS elements
+ * before the threads start, and each thread then removes its share of them.
+ */
+
+typedef struct {
+    PriorityQueue queue;
+    int pops;
+} PopTask;
+
+static void *popTask(void *argument) {
+    PopTask *task = argument;
+    for (int i = 0; i < task->pops; i++) {
+        pqRemove(task->queue);
+    }
+    return NULL;
+}
+
+/**
+ * benchPops: Fills the queue and removes all of its elements from threads threads
+ * @return
+ *      the amount of elements removed per second, or -1 if the queue couldn't be filled
+ */
+static double benchPops(PriorityQueue queue, int threads) {
+    for (int i = 0; i < ELEMENTS; i++) {
+        int priority = rand();
+        if (pqInsert(queue, &i, &priority) != PQ_SUCCESS) {
+            return -1;
+        }
+    }
+    pthread_t workers[MAX_THREADS];
+    PopTask tasks[MAX_THREADS];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < threads; i++) {
+        tasks[i].queue = queue;
+        tasks[i].pops = ELEMENTS / threads;
+        pthread_create(&workers[i], NULL, popTask, &tasks[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    return (ELEMENTS / threads) * threads / secondsSince(&start);
+}
+
+int main() {
+    printf("threads,relaxed_pops_per_second,concurrent_pops_per_second\n");
+    for (int threads = 1; threads <= MAX_THREADS; threads = threads * 2) {
+        PriorityQueue relaxed = pqCreateRelaxed(threads, SUB_QUEUES_PER_THREAD, copyInt, freeInt, equalInts, copyInt,
+                                                freeInt, compareInts);
+        PriorityQueue concurrent = pqCreateConcurrent(PQ_BACKEND_HEAP, copyInt, freeInt, equalInts, copyInt, freeInt,
+                                                      compareInts);
+        if (relaxed == NULL || concurrent == NULL) {
+            pqDestroy(relaxed);
+            pqDestroy(concurrent);
+            return 1;
+        }
+        double relaxed_rate = benchPops(relaxed, threads);
+        double concurrent_rate = benchPops(concurrent, threads);
+        printf("%d,%.0f,%.0f\n", threads, relaxed_rate, concurrent_rate);
+        pqDestroy(relaxed);
+        pqDestroy(concurrent);
+    }
+    return 0;
+}
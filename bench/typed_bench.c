@@ -0,0 +1,105 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench_utilities.h"
+#include "../priority_queue_typed.h"
+
+#define ELEMENTS 1000000
+#define RUNS 3
+
+/**
+ * Measures how long it takes to insert ELEMENTS elements of random priorities into a priority queue and then remove
+ * all of them, for a queue defined by PQ_DEFINE and for a PQ_BACKEND_HEAP queue of priority_queue.h holding the same
+ * ints. Both queues get the same priorities, and each is measured RUNS times, keeping the fastest run.
+ */
+
+static int compareTypedInts(int first, int second) {
+    return second - first;
+}
+
+static bool equalTypedInts(const int *first, const int *second) {
+    return *first == *second;
+}
+
+PQ_DEFINE(IntQueue, int, int, compareTypedInts, equalTypedInts);
+
+/**
+ * benchTyped: Inserts the priorities into a typed queue and removes them all
+ * @return
+ *      the seconds it took, or -1 if the queue couldn't be filled
+ */
+static double benchTyped(int *priorities) {
+    IntQueue queue = IntQueueCreate(NULL, NULL);
+    if (queue == NULL) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < ELEMENTS; i++) {
+        if (IntQueueInsert(queue, &i, priorities[i]) != PQ_SUCCESS) {
+            IntQueueDestroy(queue);
+            return -1;
+        }
+    }
+    while (IntQueueGetSize(queue) > 0) {
+        IntQueueRemove(queue);
+    }
+    double seconds = secondsSince(&start);
+    IntQueueDestroy(queue);
+    return seconds;
+}
+
+/**
+ * benchGeneric: Inserts the priorities into a PQ_BACKEND_HEAP queue and removes them all
+ * @return
+ *      the seconds it took, or -1 if the queue couldn't be filled
+ */
+static double benchGeneric(int *priorities) {
+    PriorityQueue queue = pqCreateWithBackend(PQ_BACKEND_HEAP, copyInt, freeInt, equalInts, copyInt, freeInt,
+                                              compareInts);
+    if (queue == NULL) {
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < ELEMENTS; i++) {
+        if (pqInsert(queue, &i, &priorities[i]) != PQ_SUCCESS) {
+            pqDestroy(queue);
+            return -1;
+        }
+    }
+    while (pqGetSize(queue) > 0) {
+        pqRemove(queue);
+    }
+    double seconds = secondsSince(&start);
+    pqDestroy(queue);
+    return seconds;
+}
+
+int main() {
+    int *priorities = malloc(sizeof(*priorities) * ELEMENTS);
+    if (priorities == NULL) {
+        return 1;
+    }
+    for (int i = 0; i < ELEMENTS; i++) {
+        priorities[i] = rand();
+    }
+    double typed = -1;
+    double generic = -1;
+    for (int run = 0; run < RUNS; run++) {
+        double typed_run = benchTyped(priorities);
+        double generic_run = benchGeneric(priorities);
+        if (typed_run < 0 || generic_run < 0) {
+            free(priorities);
+            return 1;
+        }
+        typed = typed < 0 || typed_run < typed ? typed_run : typed;
+        generic = generic < 0 || generic_run < generic ? generic_run : generic;
+    }
+    printf("elements,typed_seconds,generic_heap_seconds\n");
+    printf("%d,%.3f,%.3f\n", ELEMENTS, typed, generic);
+    free(priorities);
+    return 0;
+}
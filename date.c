@@ -125,6 +125,17 @@ int dateCompare(Date date1, Date date2) {
 
 }
 
+/**
+* dateToDays: returns the number of days from 1.1.0 to a date, so dates can be ordered and indexed by a single number
+*
+* @param date - Target Date
+* @return
+* 		The number of days, which is negative for dates before year 0.
+*/
+int dateToDays(Date date) {
+    return date->year * DAYS_IN_YEAR + (date->month - MIN_MONTH) * DAYS_IN_MONTH + (date->day - MIN_DAY);
+}
+
 /**
 * dateTick: increases the date by one day, if date is NULL should do nothing.
 *
@@ -59,6 +59,15 @@ bool dateGet(Date date, int* day, int* month, int* year);
 */
 int dateCompare(Date date1, Date date2);
 
+/**
+* dateToDays: returns the number of days from 1.1.0 to a date, so dates can be ordered and indexed by a single number
+*
+* @param date - Target Date
+* @return
+* 		The number of days, which is negative for dates before year 0.
+*/
+int dateToDays(Date date);
+
 /**
 * dateTick: increases the date by one day, if date is NULL should do nothing.
 *
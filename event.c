@@ -39,32 +39,18 @@ PQElement copyEventPQElement(PQElement event) {
     return copyEvent(event);
 }
 
-PQElementPriority copyEventPriority(PQElementPriority priority) {
-    PQElementPriority new_priority = malloc(sizeof(new_priority));
-    if (new_priority == NULL) {
-        return NULL;
-    }
-    memcpy(new_priority, priority, sizeof(PQElementPriority));
-    return new_priority;
-}
-
 void freePQEvent(PQElement event) {
     destroyEvent(event);
 }
 
-void freePQEventPriority(PQElementPriority priority) {
-    free(priority);
-}
-
 bool equalPQEvents(PQElement element1, PQElement element2) {
     Event event1 = (Event) element1, event2 = (Event) element2;
     return event1->event_id == event2->event_id;
 }
 
-int comparePQEventPriorities(PQElementPriority priority1, PQElementPriority priority2) {
-    int *event_priority1 = priority1;
-    int *event_priority2 = priority2;
-    return *event_priority2 - *event_priority1;
+unsigned long hashPQEvent(PQElement element) {
+    Event event = (Event) element;
+    return (unsigned long) event->event_id;
 }
 
 Event createEvent(char *name, Date date, int event_id) {
@@ -79,8 +65,8 @@ Event createEvent(char *name, Date date, int event_id) {
     strcpy(event->EventName, name);
     event->EventDate = dateCopy(date);
     event->event_id = event_id;
-    event->Members = pqCreate(copyMemberPQElement, freeMemberElement, equalMemberElements, copyMemberPriority,
-                              freeMemberElementPriority, compareMemberElementPriorities);
+    event->Members = pqCreateScalar(PQ_BACKEND_LIST, copyMemberPQElement, freeMemberElement, equalMemberElements,
+                                    hashMemberElement);
     return event;
 }
 
@@ -44,16 +44,6 @@ Event copyEvent(Event event);
 */
 PQElement copyEventPQElement(PQElement event_element);
 
-/**
-* copyEventPriority: Copies the event's priority.
-*
-* @param priority - event priority to copy.
-* @return
-* 	NULL - if allocation failed or @param priority is null.
-* 	PQElementPriority - in case of success.
-*/
-PQElementPriority copyEventPriority(PQElementPriority event_priority);
-
 /**
 * freeEventElement: Deallocates the event element.
 *
@@ -61,13 +51,6 @@ PQElementPriority copyEventPriority(PQElementPriority event_priority);
 */
 void freePQEvent(PQElement event_element);
 
-/**
-* freeEventElement: Deallocates the event pririty.
-*
-* @param priority - the event element priority to deallocate.
-*/
-void freePQEventPriority(PQElementPriority priority);
-
 /**
 * equalEventElements: checks if two event elements are equal.
 *
@@ -80,14 +63,13 @@ void freePQEventPriority(PQElementPriority priority);
 bool equalPQEvents(PQElement event1, PQElement event2);
 
 /**
-* compareEventElementPriorities: Compares 2 event's priorities.
+* hashPQEvent: hashes an event element by its id.
 *
-* @param priority1 - the priority of the first event.
-* @param priority2 - the priority of the second event.
+* @param event_element - the event element to hash.
 * @return
-* 	the diffrance in rank between the events
+* 	the hash of the event element.
 */
-int comparePQEventPriorities(PQElementPriority priority1, PQElementPriority priority2);
+unsigned long hashPQEvent(PQElement event_element);
 
 /**
 * eventGetName: Get the name of the provided event.
@@ -43,10 +43,9 @@ EventManager createEventManager(Date date) {
         return NULL;
     }
     em->Date = dateCopy(date);
-    em->Events = pqCreate(copyEventPQElement, freePQEvent, equalPQEvents, copyEventPriority, freePQEventPriority,
-        comparePQEventPriorities);
-    em->Members = pqCreate(copyMemberPQElement, freeMemberElement, equalMemberElements, copyMemberPriority,
-        freeMemberElementPriority, compareMemberElementPriorities);
+    em->Events = pqCreateScalar(PQ_BACKEND_WHEEL, copyEventPQElement, freePQEvent, equalPQEvents, hashPQEvent);
+    em->Members = pqCreateScalar(PQ_BACKEND_LIST, copyMemberPQElement, freeMemberElement, equalMemberElements,
+        hashMemberElement);
     return em;
 }
 
@@ -116,9 +115,11 @@ EventManagerResult emAddEventByDate(EventManager em, char* event_name, Date date
     if (new_event == NULL) {
         return EM_OUT_OF_MEMORY;
     }
-    int priority = pqGetSize(em->Events);
-    pqInsert(em->Events, new_event, &priority);
-    destroyEvent(new_event);
+    PQScalarPriority priority = dateToDays(date);
+    if (pqInsertTake(em->Events, new_event, &priority) != PQ_SUCCESS) {
+        destroyEvent(new_event);
+        return EM_OUT_OF_MEMORY;
+    }
     return EM_SUCCESS;
 }
 
@@ -178,7 +179,8 @@ EventManagerResult emAddMemberToEvent(EventManager em, int member_id, int event_
     member = pqGetFirst(em->Members);
     while (member) {
         if (memberGetId(member) == member_id) {
-            PriorityQueueResult result = pqInsert(eventGetMembers(event), member, &member_id);
+            PQScalarPriority priority = member_id;
+            PriorityQueueResult result = pqInsert(eventGetMembers(event), member, &priority);
             if (result == PQ_OUT_OF_MEMORY)
             {
                 return EM_OUT_OF_MEMORY;
@@ -252,8 +254,11 @@ EventManagerResult emAddMember(EventManager em, char* member_name, int member_id
     if (!new_member) {
         return EM_OUT_OF_MEMORY;
     }
-    pqInsert(em->Members, new_member, &member_id);
-    destroyMember(new_member);
+    PQScalarPriority priority = member_id;
+    if (pqInsertTake(em->Members, new_member, &priority) != PQ_SUCCESS) {
+        destroyMember(new_member);
+        return EM_OUT_OF_MEMORY;
+    }
     return EM_SUCCESS;
 }
 
@@ -305,14 +310,10 @@ EventManagerResult emTick(EventManager em, int days) {
         days--;
         dateTick(em->Date);
     }
-    Event event = pqGetFirst(em->Events);
-    while (event)
+    Event event = NULL;
+    while (pqPeekTopK(em->Events, 1, (PQElement*) &event) == 1 && dateCompare(em->Date, eventGetDate(event)) > 0)
     {
-        if (dateCompare(em->Date, eventGetDate(event)) > 0)
-        {
-            emRemoveEvent(em, eventGetId(event));
-        }
-        event = pqGetNext(em->Events);
+        pqRemove(em->Events);
     }
     return EM_SUCCESS;
 }
@@ -347,41 +348,12 @@ int getEventsAmountByMember(EventManager em, Member m) {
     return count;
 }
 
-int emGetNextEventId(PriorityQueue Events, Date date) {
-    if (!Events || !date) {
-        return ELEMENT_NOT_FOUND;
-    }
-    Event event = pqGetFirst(Events);
-    if (!event) {
-        return ELEMENT_NOT_FOUND;
-    }
-    int min = 0, min_id = eventGetId(event);
-    bool found = false;
-    while (event) {
-        int days_diff = dateCompare(eventGetDate(event), date);
-        if ((days_diff < min || !found) && days_diff >= 0) {
-            min = days_diff;
-            min_id = eventGetId(event);
-            found = true;
-        }
-        event = pqGetNext(Events);
-    }
-    if (!found) {
-        return ELEMENT_NOT_FOUND;
-    }
-    return min_id;
-}
-
 char* emGetNextEvent(EventManager em) {
     if (!em) {
         return NULL;
     }
-    int id = emGetNextEventId(em->Events, em->Date);
-    if (id == ELEMENT_NOT_FOUND) {
-        return NULL;
-    }
-    Event event = GetEventById(em, id);
-    if (!event) {
+    Event event = NULL;
+    if (pqPeekTopK(em->Events, 1, (PQElement*) &event) != 1) {
         return NULL;
     }
     return eventGetName(event);
@@ -390,17 +362,14 @@ char* emGetNextEvent(EventManager em) {
 void emPrintAllEvents(EventManager em, const char* file_name) {
     if (em && file_name)
     {
-        PriorityQueue Events = pqCopy(em->Events);
-        Event event;
         char str[40000];
         int pos = 0;
         int day, month, year;
         Member member;
-        int size = pqGetSize(em->Events);
-        for (int i = 0; i < size; i++)
+        Event event = pqGetFirst(em->Events);
+        while (event)
         {
-            event = GetEventById(em, emGetNextEventId(Events, em->Date));
-            if (event) {
+            if (dateCompare(em->Date, eventGetDate(event)) <= 0) {
                 dateGet(eventGetDate(event), &day, &month, &year);
                 pos += sprintf(&str[pos], "%s,", eventGetName(event));
                 pos += sprintf(&str[pos], "%d.%d.%d", day, month, year);
@@ -411,7 +380,7 @@ void emPrintAllEvents(EventManager em, const char* file_name) {
                 }
                 pos += sprintf(&str[pos], "\n");
             }
-            pqRemoveElement(Events, event);
+            event = pqGetNext(em->Events);
         }
         FILE* fp = fopen(file_name, "w");
         if (pos != 0)
@@ -419,7 +388,6 @@ void emPrintAllEvents(EventManager em, const char* file_name) {
             fprintf(fp, "%s", str);
         }
         fclose(fp);
-        pqDestroy(Events);
     }
 }
 
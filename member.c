@@ -14,32 +14,18 @@ void destroyMember(Member member) {
     free(member);
 }
 
-PQElementPriority copyMemberPriority(PQElementPriority priority) {
-    PQElementPriority new_priority = malloc(sizeof(new_priority));
-    if (new_priority == NULL){
-        return NULL;
-    }
-    memcpy(new_priority, priority, sizeof(PQElementPriority));
-    return new_priority;
-}
-
 void freeMemberElement(PQElement member_element) {
     destroyMember(member_element);
 }
 
-void freeMemberElementPriority(PQElementPriority priority) {
-    free(priority);
-}
-
 bool equalMemberElements(PQElement member_element1, PQElement member_element2) {
     Member member1 = (Member) member_element1, member2 = (Member) member_element2;
     return member1->member_id == member2->member_id;
 }
 
-int compareMemberElementPriorities(PQElementPriority priority1, PQElementPriority priority2) {
-    int *member_priority1 = priority1;
-    int *member_priority2 = priority2;
-    return *member_priority2 - *member_priority1;
+unsigned long hashMemberElement(PQElement member_element) {
+    Member member = (Member) member_element;
+    return (unsigned long) member->member_id;
 }
 
 Member copyMember(Member member) {
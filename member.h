@@ -23,16 +23,6 @@ Member copyMember(Member m);
 */
 void destroyMember(Member m);
 
-/**
-* copyMemberPriority: Copies the member's priority.
-*
-* @param priority - member priority to copy.
-* @return
-* 	NULL - if allocation failed or @param priority is null.
-* 	PQElementPriority - in case of success.
-*/
-PQElementPriority copyMemberPriority(PQElementPriority priority);
-
 /**
 * freeMemberElement: Deallocates the member element.
 *
@@ -40,13 +30,6 @@ PQElementPriority copyMemberPriority(PQElementPriority priority);
 */
 void freeMemberElement(PQElement member_element);
 
-/**
-* freeMemberElementPriority: Deallocates member priority.
-*
-* @param priority - the priority to deallocate.
-*/
-void freeMemberElementPriority(PQElementPriority priority);
-
 /**
 * equalMemberElements: checks if two member elements are equal.
 *
@@ -59,14 +42,13 @@ void freeMemberElementPriority(PQElementPriority priority);
 bool equalMemberElements(PQElement member_element1, PQElement member_element2);
 
 /**
-* compareMemberElementPriorities: Compares 2 member's priorities.
+* hashMemberElement: hashes a member element by its id.
 *
-* @param priority1 - the priority of the first member.
-* @param priority2 - the priority of the second member.
+* @param member_element - the member element to hash.
 * @return
-* 	the diffrance in rank between the members
+* 	the hash of the member element.
 */
-int compareMemberElementPriorities(PQElementPriority priority1, PQElementPriority priority2);
+unsigned long hashMemberElement(PQElement member_element);
 
 /**
 * createMember: Allocates a new member.
@@ -0,0 +1,271 @@
+#include "pqArray.h"
+#include "pqStats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_INITIAL_CAPACITY 16
+#define ARRAY_GROWTH_FACTOR 2
+/** The array is compacted instead of grown while at most capacity - capacity / ARRAY_SLACK_FRACTION is used */
+#define ARRAY_SLACK_FRACTION 4
+
+/*
+ * STATIC FUNCTIONS FOR pqArray
+ */
+
+/**
+ * pqArrayMove: Moves count positions of the array from one position to another, in both of its arrays
+ * @param array
+ * @param from
+ * @param to
+ * @param count
+ */
+static void pqArrayMove(pqArray array, int from, int to, int count) {
+    if (count <= 0 || from == to) {
+        return;
+    }
+    memmove(array->priorities + to, array->priorities + from, sizeof(*array->priorities) * count);
+    memmove(array->nodes + to, array->nodes + from, sizeof(*array->nodes) * count);
+}
+
+/**
+ * pqArrayBound: Finds the first position of the array whose node doesn't come before a node of a certain priority
+ * and sequence, by a binary search
+ * @param array
+ * @param priority
+ * @param sequence
+ * @return
+ *      the position of that node, start + size if every node comes before it
+ */
+static int pqArrayBound(pqArray array, PQScalarPriority priority, unsigned long sequence) {
+    int low = array->start;
+    int high = array->start + array->size;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        PQ_COUNT(comparisons, 1);
+        if (array->priorities[middle] < priority ||
+            (array->priorities[middle] == priority && array->nodes[middle]->sequence < sequence)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * pqArrayGrow: Moves the nodes of the array to new arrays of at least size + count positions, starting at position 0
+ * @param array
+ * @param count
+ * @return
+ *      false if memory allocation failed, the array is unchanged in that case
+ *      true otherwise
+ */
+static bool pqArrayGrow(pqArray array, int count) {
+    int new_capacity = array->capacity == 0 ? ARRAY_INITIAL_CAPACITY : array->capacity * ARRAY_GROWTH_FACTOR;
+    if (new_capacity < array->size + count) {
+        new_capacity = array->size + count;
+    }
+    PQScalarPriority *new_priorities = malloc(sizeof(*new_priorities) * new_capacity);
+    PQ_COUNT_ALLOCATION(new_priorities, sizeof(*new_priorities) * new_capacity);
+    pqNode *new_nodes = malloc(sizeof(*new_nodes) * new_capacity);
+    PQ_COUNT_ALLOCATION(new_nodes, sizeof(*new_nodes) * new_capacity);
+    if (new_priorities == NULL || new_nodes == NULL) {
+        free(new_priorities);
+        free(new_nodes);
+        return false;
+    }
+    if (array->size > 0) {
+        memcpy(new_priorities, array->priorities + array->start, sizeof(*new_priorities) * array->size);
+        memcpy(new_nodes, array->nodes + array->start, sizeof(*new_nodes) * array->size);
+    }
+    free(array->priorities);
+    free(array->nodes);
+    array->priorities = new_priorities;
+    array->nodes = new_nodes;
+    array->start = 0;
+    array->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * pqArrayMakeRoom: Makes sure there are count free positions after the last node of the array. The nodes are moved
+ * back to position 0 if the array has enough slack left, so the positions freed by removing the first nodes are
+ * reused, and a compaction is paid for by the capacity / ARRAY_SLACK_FRACTION removals that freed them. Otherwise the
+ * array grows
+ * @param array
+ * @param count
+ * @return
+ *      false if memory allocation failed, the array is unchanged in that case
+ *      true otherwise
+ */
+static bool pqArrayMakeRoom(pqArray array, int count) {
+    if (array->start + array->size + count <= array->capacity) {
+        return true;
+    }
+    bool compact = array->size + count <= array->capacity - array->capacity / ARRAY_SLACK_FRACTION;
+    if (compact == false && pqArrayGrow(array, count)) {
+        return true;
+    }
+    if (array->size + count > array->capacity) {
+        return false;
+    }
+    pqArrayMove(array, array->start, 0, array->size);
+    array->start = 0;
+    return true;
+}
+
+
+/*
+ * FUNCTIONS FOR pqArray
+ */
+
+pqArray pqArrayCreate(void) {
+    pqArray array = malloc(sizeof(*array));
+    if (array == NULL) {
+        return NULL;
+    }
+    array->priorities = NULL;
+    array->nodes = NULL;
+    array->start = 0;
+    array->size = 0;
+    array->capacity = 0;
+    return array;
+}
+
+void pqArrayDestroy(pqArray array) {
+    if (array == NULL) {
+        return;
+    }
+    free(array->priorities);
+    free(array->nodes);
+    free(array);
+}
+
+bool pqArrayReserve(pqArray array, int capacity) {
+    if (array == NULL) {
+        return false;
+    }
+    return pqArrayMakeRoom(array, capacity - array->size);
+}
+
+bool pqArrayPush(pqArray array, pqNode node) {
+    if (array == NULL || node == NULL) {
+        return false;
+    }
+    int end = array->start + array->size;
+    int position = pqArrayBound(array, node->priority.scalar, node->sequence);
+    if (array->start > 0 && position - array->start < end - position) {
+        pqArrayMove(array, array->start, array->start - 1, position - array->start);
+        array->start = array->start - 1;
+        position = position - 1;
+    } else {
+        int offset = position - array->start;
+        if (pqArrayMakeRoom(array, 1) == false) {
+            return false;
+        }
+        position = array->start + offset;
+        pqArrayMove(array, position, position + 1, array->size - offset);
+    }
+    array->priorities[position] = node->priority.scalar;
+    array->nodes[position] = node;
+    array->size = array->size + 1;
+    return true;
+}
+
+bool pqArrayPushAll(pqArray array, pqNode *nodes, int count) {
+    if (array == NULL || nodes == NULL) {
+        return false;
+    }
+    if (count <= 0) {
+        return true;
+    }
+    if (pqArrayReserve(array, array->size + count) == false || pqNodeSort(nodes, count, NULL) == false) {
+        return false;
+    }
+    pqArrayMove(array, array->start, count, array->size);
+    int read = count;
+    int end = count + array->size;
+    int written = 0;
+    for (int next = 0; next < count; written++) {
+        PQ_COUNT(comparisons, 1);
+        if (read < end && (array->priorities[read] < nodes[next]->priority.scalar ||
+                           (array->priorities[read] == nodes[next]->priority.scalar &&
+                            array->nodes[read]->sequence < nodes[next]->sequence))) {
+            array->priorities[written] = array->priorities[read];
+            array->nodes[written] = array->nodes[read];
+            read = read + 1;
+        } else {
+            array->priorities[written] = nodes[next]->priority.scalar;
+            array->nodes[written] = nodes[next];
+            next = next + 1;
+        }
+    }
+    array->start = 0;
+    array->size = end;
+    return true;
+}
+
+pqNode pqArrayTop(pqArray array) {
+    if (array == NULL || array->size == 0) {
+        return NULL;
+    }
+    return array->nodes[array->start];
+}
+
+int pqArrayTopK(pqArray array, int k, pqNode *out) {
+    if (k > array->size) {
+        k = array->size;
+    }
+    if (k <= 0) {
+        return 0;
+    }
+    memcpy(out, array->nodes + array->start, sizeof(*out) * k);
+    return k;
+}
+
+void pqArrayRemove(pqArray array, pqNode node) {
+    int end = array->start + array->size;
+    int position;
+    if (array->nodes[array->start] == node) {
+        position = array->start;
+    } else if (array->nodes[end - 1] == node) {
+        position = end - 1;
+    } else {
+        position = pqArrayBound(array, node->priority.scalar, node->sequence);
+        while (array->nodes[position] != node) {
+            position = position + 1;
+        }
+    }
+    if (position - array->start < end - 1 - position) {
+        pqArrayMove(array, array->start, array->start + 1, position - array->start);
+        array->start = array->start + 1;
+    } else {
+        pqArrayMove(array, position + 1, position, end - 1 - position);
+    }
+    array->size = array->size - 1;
+    if (array->size == 0) {
+        array->start = 0;
+    }
+}
+
+int pqArrayFind(pqArray array, PQScalarPriority priority) {
+    int position = pqArrayBound(array, priority, 0);
+    if (position == array->start + array->size || array->priorities[position] != priority) {
+        return array->size;
+    }
+    return position - array->start;
+}
+
+pqNode pqArrayGet(pqArray array, int index) {
+    if (array == NULL || index < 0 || index >= array->size) {
+        return NULL;
+    }
+    return array->nodes[array->start + index];
+}
+
+int pqArrayGetSize(pqArray array) {
+    if (array == NULL) {
+        return 0;
+    }
+    return array->size;
+}
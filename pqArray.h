@@ -0,0 +1,137 @@
+#ifndef EX1_PQARRAY_H
+#define EX1_PQARRAY_H
+
+#include <stdbool.h>
+#include "priority_queue.h"
+#include "pqNode.h"
+
+typedef struct pqArray_t *pqArray;
+
+
+/*
+ * STRUCTS
+ */
+
+/**
+ * Struct representing the nodes of a scalar queue as a structure of arrays sorted in the order of the queue: the
+ * positions from start to start + size - 1 hold the nodes from the first to the last, priorities the priority of
+ * every node, contiguous, and nodes the node itself at the same position. The highest priority node is at start, so
+ * removing it only moves start forward, and a node is found by a binary search over the priorities, reading the nodes
+ * only for their sequences between equal priorities. Inserting or removing elsewhere moves the positions on the
+ * shorter side of it, with one memmove in each array. Like the heap, the array does not own the nodes it holds, and
+ * node->index isn't used
+ */
+struct pqArray_t {
+    PQScalarPriority *priorities;
+    pqNode *nodes;
+    int start;
+    int size;
+    int capacity;
+};
+
+/**
+ * pqArrayCreate: Creates a new empty array
+ * @return
+ *      NULL if memory allocation failed
+ *      the new array if it didn't
+ */
+pqArray pqArrayCreate(void);
+
+/**
+ * pqArrayDestroy: Frees the array itself, the nodes inside it are not freed
+ * @param array
+ */
+void pqArrayDestroy(pqArray array);
+
+/**
+ * pqArrayReserve: Makes sure the array can hold capacity nodes without growing
+ * @param array
+ * @param capacity
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+bool pqArrayReserve(pqArray array, int capacity);
+
+/**
+ * pqArrayPush: Adds a node at its position in the order of the array, in O(log n) comparisons and O(n) moves of the
+ * shorter side. A node that comes after all the others, or before all of them once the first was removed, is added
+ * without moving any
+ * @param array
+ * @param node
+ * @return
+ *      false if memory allocation failed, the array is unchanged in that case
+ *      true otherwise
+ */
+bool pqArrayPush(pqArray array, pqNode node);
+
+/**
+ * pqArrayPushAll: Adds count nodes to the array at once, sorting them and merging them with the array in
+ * O(n + count log count)
+ * @param array
+ * @param nodes - the nodes to add, they are sorted in place
+ * @param count
+ * @return
+ *      false if memory allocation failed, the array is unchanged in that case
+ *      true otherwise
+ */
+bool pqArrayPushAll(pqArray array, pqNode *nodes, int count);
+
+/**
+ * pqArrayTop: Retrieve the highest priority node of the array in O(1), ties are broken by the node's sequence
+ * @param array
+ * @return
+ *      NULL if the array is empty
+ *      the top node otherwise
+ */
+pqNode pqArrayTop(pqArray array);
+
+/**
+ * pqArrayTopK: Retrieve the k highest priority nodes of the array in order in O(k), without changing the array
+ * @param array
+ * @param k
+ * @param out - an array of at least k nodes that receives the nodes
+ * @return
+ *      the amount of nodes written to out, k or the size of the array if it is smaller
+ */
+int pqArrayTopK(pqArray array, int k, pqNode *out);
+
+/**
+ * pqArrayRemove: Removes a node from the array, found by a binary search on its priority and sequence, which must not
+ * have changed since it was pushed. O(1) for the first and last nodes, O(n) moves of the shorter side otherwise
+ * @param array
+ * @param node
+ */
+void pqArrayRemove(pqArray array, pqNode node);
+
+/**
+ * pqArrayFind: Retrieve the position of the highest priority node of the array that has a certain priority, in
+ * O(log n). The nodes holding that priority follow it
+ * @param array
+ * @param priority
+ * @return
+ *      the size of the array if no node has that priority
+ *      the position of the node otherwise
+ */
+int pqArrayFind(pqArray array, PQScalarPriority priority);
+
+/**
+ * pqArrayGet: Retrieve the node at a specific position of the array, position 0 holds the highest priority node
+ * @param array
+ * @param index
+ * @return
+ *      NULL if index is out of range
+ *      the node otherwise
+ */
+pqNode pqArrayGet(pqArray array, int index);
+
+/**
+ * pqArrayGetSize: Retrieve the amount of nodes in the array
+ * @param array
+ * @return
+ *      the amount of nodes in the array
+ */
+int pqArrayGetSize(pqArray array);
+
+
+#endif //EX1_PQARRAY_H
@@ -0,0 +1,55 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "pqBuffer.h"
+#include <stdlib.h>
+
+/*
+ * FUNCTIONS FOR pqBuffer
+ */
+
+pqBuffer pqBufferCreate(int capacity) {
+    pqBuffer buffer = malloc(sizeof(*buffer));
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->elements = malloc(sizeof(*buffer->elements) * capacity);
+    buffer->priorities = malloc(sizeof(*buffer->priorities) * capacity);
+    if (buffer->elements == NULL || buffer->priorities == NULL || pthread_mutex_init(&buffer->lock, NULL) != 0) {
+        free(buffer->elements);
+        free(buffer->priorities);
+        free(buffer);
+        return NULL;
+    }
+    buffer->size = 0;
+    buffer->capacity = capacity;
+    buffer->abandoned = false;
+    buffer->next = NULL;
+    return buffer;
+}
+
+void pqBufferDestroy(pqBuffer buffer, FreePQElement free_element, FreePQElementPriority free_priority) {
+    if (buffer == NULL) {
+        return;
+    }
+    for (int i = 0; i < buffer->size; i++) {
+        free_element(buffer->elements[i]);
+        if (free_priority != NULL) {
+            free_priority(buffer->priorities[i]);
+        }
+    }
+    pthread_mutex_destroy(&buffer->lock);
+    free(buffer->elements);
+    free(buffer->priorities);
+    free(buffer);
+}
+
+bool pqBufferAppend(pqBuffer buffer, PQElement element, PQElementPriority priority) {
+    buffer->elements[buffer->size] = element;
+    buffer->priorities[buffer->size] = priority;
+    buffer->size = buffer->size + 1;
+    return buffer->size == buffer->capacity;
+}
+
+bool pqBufferIsFull(pqBuffer buffer) {
+    return buffer->size == buffer->capacity;
+}
@@ -0,0 +1,69 @@
+#ifndef EX1_PQBUFFER_H
+#define EX1_PQBUFFER_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "priority_queue.h"
+
+typedef struct pqBuffer_t *pqBuffer;
+
+
+/*
+ * STRUCTS
+ */
+
+/**
+ * Struct representing the insert buffer of one producer thread, holding up to capacity elements with their
+ * priorities until they are flushed into the queue. The buffer owns the elements and priorities it holds.
+ * Only its thread appends to it, so its lock is rarely contended, and abandoned is set once the thread exits.
+ * The buffers of a queue are linked through next
+ */
+struct pqBuffer_t {
+    pthread_mutex_t lock;
+    PQElement *elements;
+    PQElementPriority *priorities;
+    int size;
+    int capacity;
+    bool abandoned;
+    pqBuffer next;
+};
+
+/**
+ * pqBufferCreate: Creates a new empty buffer
+ * @param capacity - the amount of elements the buffer can hold
+ * @return
+ *      NULL if memory allocation failed
+ *      the new buffer if it didn't
+ */
+pqBuffer pqBufferCreate(int capacity);
+
+/**
+ * pqBufferDestroy: Frees the buffer along with the elements and priorities it holds
+ * @param buffer
+ * @param free_element
+ * @param free_priority - can be NULL if the priorities are not to be freed
+ */
+void pqBufferDestroy(pqBuffer buffer, FreePQElement free_element, FreePQElementPriority free_priority);
+
+/**
+ * pqBufferAppend: Adds an element and its priority to the end of a buffer that isn't full, taking ownership of both
+ * @param buffer
+ * @param element
+ * @param priority
+ * @return
+ *      true if the buffer is full after adding them
+ *      false otherwise
+ */
+bool pqBufferAppend(pqBuffer buffer, PQElement element, PQElementPriority priority);
+
+/**
+ * pqBufferIsFull: Whether the buffer holds capacity elements
+ * @param buffer
+ * @return
+ *      true if the buffer is full
+ *      false otherwise
+ */
+bool pqBufferIsFull(pqBuffer buffer);
+
+
+#endif //EX1_PQBUFFER_H
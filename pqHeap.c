@@ -0,0 +1,520 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "pqHeap.h"
+#include "pqStats.h"
+#include <stdlib.h>
+#include <sched.h>
+
+#define HEAP_ARITY 4
+#define HEAP_INITIAL_CAPACITY 16
+#define HEAP_GROWTH_FACTOR 2
+#define SLOT_EMPTY 0
+#define SLOT_AVAILABLE 1
+#define FIRST_TICKET 2
+
+/*
+ * STATIC FUNCTIONS FOR pqHeap
+ */
+
+/**
+ * pqHeapPlace: Puts a node in a position of the heap and updates the node's index accordingly
+ * @param heap
+ * @param node
+ * @param index
+ */
+inline static void pqHeapPlace(pqHeap heap, pqNode node, int index) {
+    heap->nodes[index] = node;
+    node->index = index;
+    if (heap->slots != NULL) {
+        heap->slots[index].tag = SLOT_AVAILABLE;
+    }
+}
+
+/**
+ * pqHeapSiftUp: Moves the node at index up until its parent is of higher priority
+ * @param heap
+ * @param index
+ */
+static void pqHeapSiftUp(pqHeap heap, int index) {
+    pqNode node = heap->nodes[index];
+    while (index > 0) {
+        int parent = (index - 1) / HEAP_ARITY;
+        PQ_COUNT(insert_traversals, 1);
+        if (pqNodeCompare(node, heap->nodes[parent], heap->comparePriorities) <= 0) {
+            break;
+        }
+        pqHeapPlace(heap, heap->nodes[parent], index);
+        index = parent;
+    }
+    pqHeapPlace(heap, node, index);
+}
+
+/**
+ * pqHeapSiftDown: Moves the node at index down until all of its children are of lower priority
+ * @param heap
+ * @param index
+ */
+static void pqHeapSiftDown(pqHeap heap, int index) {
+    pqNode node = heap->nodes[index];
+    while (true) {
+        int first_child = index * HEAP_ARITY + 1;
+        if (first_child >= heap->size) {
+            break;
+        }
+        int last_child = first_child + HEAP_ARITY;
+        if (last_child > heap->size) {
+            last_child = heap->size;
+        }
+        int best = first_child;
+        for (int child = first_child + 1; child < last_child; child++) {
+            if (pqNodeCompare(heap->nodes[child], heap->nodes[best], heap->comparePriorities) > 0) {
+                best = child;
+            }
+        }
+        if (pqNodeCompare(heap->nodes[best], node, heap->comparePriorities) <= 0) {
+            break;
+        }
+        pqHeapPlace(heap, heap->nodes[best], index);
+        index = best;
+    }
+    pqHeapPlace(heap, node, index);
+}
+
+/**
+ * pqHeapGrow: Makes sure there is room for count more nodes in the heap
+ * @param heap
+ * @param count
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqHeapGrow(pqHeap heap, int count) {
+    if (heap->size + count <= heap->capacity) {
+        return true;
+    }
+    int new_capacity = heap->capacity == 0 ? HEAP_INITIAL_CAPACITY : heap->capacity * HEAP_GROWTH_FACTOR;
+    if (new_capacity < heap->size + count) {
+        new_capacity = heap->size + count;
+    }
+    pqNode *new_nodes = realloc(heap->nodes, sizeof(*new_nodes) * new_capacity);
+    PQ_COUNT_ALLOCATION(new_nodes, sizeof(*new_nodes) * new_capacity);
+    if (new_nodes == NULL) {
+        return false;
+    }
+    heap->nodes = new_nodes;
+    if (heap->slots != NULL) {
+        pqHeapSlot *new_slots = realloc(heap->slots, sizeof(*new_slots) * new_capacity);
+        PQ_COUNT_ALLOCATION(new_slots, sizeof(*new_slots) * new_capacity);
+        if (new_slots == NULL) {
+            return false;
+        }
+        for (int i = heap->capacity; i < new_capacity; i++) {
+            new_slots[i].locked = false;
+            new_slots[i].tag = SLOT_EMPTY;
+        }
+        heap->slots = new_slots;
+    }
+    heap->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * pqHeapLockSlot: Takes the lock of a position of a concurrent heap. The locks are only held for a few comparisons,
+ * so a thread that finds one taken yields to the thread holding it rather than sleeping
+ * @param heap
+ * @param index
+ */
+inline static void pqHeapLockSlot(pqHeap heap, int index) {
+    while (__atomic_test_and_set(&heap->slots[index].locked, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+}
+
+/**
+ * pqHeapUnlockSlot: Releases the lock of a position of a concurrent heap
+ * @param heap
+ * @param index
+ */
+inline static void pqHeapUnlockSlot(pqHeap heap, int index) {
+    __atomic_clear(&heap->slots[index].locked, __ATOMIC_RELEASE);
+}
+
+/**
+ * pqHeapSwap: Swaps the nodes at two locked positions of a concurrent heap, with their tags
+ * @param heap
+ * @param first
+ * @param second
+ */
+static void pqHeapSwap(pqHeap heap, int first, int second) {
+    pqNode node = heap->nodes[first];
+    unsigned long tag = heap->slots[first].tag;
+    heap->nodes[first] = heap->nodes[second];
+    heap->nodes[first]->index = first;
+    heap->slots[first].tag = heap->slots[second].tag;
+    heap->nodes[second] = node;
+    node->index = second;
+    heap->slots[second].tag = tag;
+}
+
+/**
+ * pqHeapLockBestChild: Locks the children of a locked position of a concurrent heap, in order, and keeps the lock of
+ * the highest priority one among those holding a node
+ * @param heap
+ * @param index
+ * @return
+ *      -1 if none of the children holds a node, no lock is kept in that case
+ *      the position of the best child otherwise
+ */
+static int pqHeapLockBestChild(pqHeap heap, int index) {
+    int first_child = index * HEAP_ARITY + 1;
+    int last_child = first_child + HEAP_ARITY;
+    if (last_child > heap->capacity) {
+        last_child = heap->capacity;
+    }
+    int best = -1;
+    for (int child = first_child; child < last_child; child++) {
+        pqHeapLockSlot(heap, child);
+        if (heap->slots[child].tag == SLOT_EMPTY) {
+            pqHeapUnlockSlot(heap, child);
+        } else if (best < 0 || pqNodeCompare(heap->nodes[child], heap->nodes[best], heap->comparePriorities) > 0) {
+            if (best >= 0) {
+                pqHeapUnlockSlot(heap, best);
+            }
+            best = child;
+        } else {
+            pqHeapUnlockSlot(heap, child);
+        }
+    }
+    return best;
+}
+
+/**
+ * pqHeapCandidatesSiftUp: Moves a candidate up a binary heap of candidates, positions in heap ordered by their nodes
+ * @param heap
+ * @param candidates
+ * @param index
+ */
+static void pqHeapCandidatesSiftUp(pqHeap heap, int *candidates, int index) {
+    int candidate = candidates[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (pqNodeCompare(heap->nodes[candidate], heap->nodes[candidates[parent]], heap->comparePriorities) <= 0) {
+            break;
+        }
+        candidates[index] = candidates[parent];
+        index = parent;
+    }
+    candidates[index] = candidate;
+}
+
+/**
+ * pqHeapCandidatesSiftDown: Moves a candidate down a binary heap of count candidates
+ * @param heap
+ * @param candidates
+ * @param count
+ * @param index
+ */
+static void pqHeapCandidatesSiftDown(pqHeap heap, int *candidates, int count, int index) {
+    if (count == 0) {
+        return;
+    }
+    int candidate = candidates[index];
+    while (index * 2 + 1 < count) {
+        int best = index * 2 + 1;
+        if (best + 1 < count && pqNodeCompare(heap->nodes[candidates[best + 1]], heap->nodes[candidates[best]],
+                                              heap->comparePriorities) > 0) {
+            best = best + 1;
+        }
+        if (pqNodeCompare(heap->nodes[candidates[best]], heap->nodes[candidate], heap->comparePriorities) <= 0) {
+            break;
+        }
+        candidates[index] = candidates[best];
+        index = best;
+    }
+    candidates[index] = candidate;
+}
+
+
+/*
+ * FUNCTIONS FOR pqHeap
+ */
+
+pqHeap pqHeapCreate(ComparePQElementPriorities compare_priorities) {
+    pqHeap heap = malloc(sizeof(*heap));
+    if (heap == NULL) {
+        return NULL;
+    }
+    heap->nodes = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+    heap->comparePriorities = compare_priorities;
+    heap->slots = NULL;
+    heap->reserved = 0;
+    heap->tickets = FIRST_TICKET;
+    return heap;
+}
+
+void pqHeapDestroy(pqHeap heap) {
+    if (heap == NULL) {
+        return;
+    }
+    if (heap->slots != NULL) {
+        pthread_mutex_destroy(&heap->lock);
+        free(heap->slots);
+    }
+    free(heap->nodes);
+    free(heap);
+}
+
+bool pqHeapReserve(pqHeap heap, int capacity) {
+    if (heap == NULL) {
+        return false;
+    }
+    return pqHeapGrow(heap, capacity - heap->size);
+}
+
+bool pqHeapPush(pqHeap heap, pqNode node) {
+    if (heap == NULL || node == NULL || pqHeapGrow(heap, 1) == false) {
+        return false;
+    }
+    heap->size = heap->size + 1;
+    pqHeapPlace(heap, node, heap->size - 1);
+    pqHeapSiftUp(heap, heap->size - 1);
+    return true;
+}
+
+bool pqHeapPushAll(pqHeap heap, pqNode *nodes, int count) {
+    if (heap == NULL || nodes == NULL || pqHeapGrow(heap, count) == false) {
+        return false;
+    }
+    if (count <= heap->size) {
+        for (int i = 0; i < count; i++) {
+            pqHeapPush(heap, nodes[i]);
+        }
+        return true;
+    }
+    for (int i = 0; i < count; i++) {
+        pqHeapPlace(heap, nodes[i], heap->size + i);
+    }
+    heap->size = heap->size + count;
+    for (int i = (heap->size - 2) / HEAP_ARITY; i >= 0; i--) {
+        pqHeapSiftDown(heap, i);
+    }
+    return true;
+}
+
+pqNode pqHeapTop(pqHeap heap) {
+    if (heap == NULL || heap->size == 0) {
+        return NULL;
+    }
+    return heap->nodes[0];
+}
+
+int pqHeapTopK(pqHeap heap, int k, pqNode *out) {
+    if (k > heap->size) {
+        k = heap->size;
+    }
+    if (k <= 0) {
+        return 0;
+    }
+    int *candidates = malloc(sizeof(*candidates) * (k * (HEAP_ARITY - 1) + 1));
+    PQ_COUNT_ALLOCATION(candidates, sizeof(*candidates) * (k * (HEAP_ARITY - 1) + 1));
+    if (candidates == NULL) {
+        return -1;
+    }
+    int count = 1;
+    candidates[0] = 0;
+    for (int taken = 0; taken < k; taken++) {
+        int top = candidates[0];
+        out[taken] = heap->nodes[top];
+        count = count - 1;
+        candidates[0] = candidates[count];
+        pqHeapCandidatesSiftDown(heap, candidates, count, 0);
+        int last_child = top * HEAP_ARITY + HEAP_ARITY;
+        for (int child = top * HEAP_ARITY + 1; child <= last_child && child < heap->size; child++) {
+            candidates[count] = child;
+            count = count + 1;
+            pqHeapCandidatesSiftUp(heap, candidates, count - 1);
+        }
+    }
+    free(candidates);
+    return k;
+}
+
+pqNode pqHeapRemoveAt(pqHeap heap, int index) {
+    if (heap == NULL || index < 0 || index >= heap->size) {
+        return NULL;
+    }
+    pqNode removed = heap->nodes[index];
+    heap->size = heap->size - 1;
+    if (index != heap->size) {
+        pqHeapPlace(heap, heap->nodes[heap->size], index);
+        pqHeapUpdate(heap, index);
+    }
+    if (heap->slots != NULL) {
+        heap->slots[heap->size].tag = SLOT_EMPTY;
+    }
+    removed->index = NODE_NOT_IN_HEAP;
+    return removed;
+}
+
+void pqHeapUpdate(pqHeap heap, int index) {
+    if (heap == NULL || index < 0 || index >= heap->size) {
+        return;
+    }
+    if (index > 0 &&
+        pqNodeCompare(heap->nodes[index], heap->nodes[(index - 1) / HEAP_ARITY], heap->comparePriorities) > 0) {
+        pqHeapSiftUp(heap, index);
+    } else {
+        pqHeapSiftDown(heap, index);
+    }
+}
+
+pqNode pqHeapGet(pqHeap heap, int index) {
+    if (heap == NULL || index < 0 || index >= heap->size) {
+        return NULL;
+    }
+    return heap->nodes[index];
+}
+
+bool pqHeapMakeConcurrent(pqHeap heap) {
+    if (heap == NULL || pqHeapGrow(heap, HEAP_INITIAL_CAPACITY) == false) {
+        return false;
+    }
+    if (heap->slots != NULL) {
+        return true;
+    }
+    pqHeapSlot *slots = malloc(sizeof(*slots) * heap->capacity);
+    PQ_COUNT_ALLOCATION(slots, sizeof(*slots) * heap->capacity);
+    if (slots == NULL) {
+        return false;
+    }
+    if (pthread_mutex_init(&heap->lock, NULL) != 0) {
+        free(slots);
+        return false;
+    }
+    for (int i = 0; i < heap->capacity; i++) {
+        slots[i].locked = false;
+        slots[i].tag = i < heap->size ? SLOT_AVAILABLE : SLOT_EMPTY;
+    }
+    heap->slots = slots;
+    return true;
+}
+
+bool pqHeapIsConcurrent(pqHeap heap) {
+    return heap != NULL && heap->slots != NULL;
+}
+
+bool pqHeapConcurrentClaim(pqHeap heap) {
+    pthread_mutex_lock(&heap->lock);
+    bool claimed = heap->size + heap->reserved < heap->capacity;
+    if (claimed) {
+        heap->reserved = heap->reserved + 1;
+    }
+    pthread_mutex_unlock(&heap->lock);
+    return claimed;
+}
+
+void pqHeapConcurrentUnclaim(pqHeap heap) {
+    pthread_mutex_lock(&heap->lock);
+    heap->reserved = heap->reserved - 1;
+    pthread_mutex_unlock(&heap->lock);
+}
+
+void pqHeapConcurrentPush(pqHeap heap, pqNode node) {
+    pthread_mutex_lock(&heap->lock);
+    heap->reserved = heap->reserved - 1;
+    int index = heap->size;
+    heap->size = heap->size + 1;
+    unsigned long ticket = heap->tickets;
+    heap->tickets = heap->tickets + 1;
+    pqHeapLockSlot(heap, index);
+    pthread_mutex_unlock(&heap->lock);
+    heap->nodes[index] = node;
+    node->index = index;
+    heap->slots[index].tag = ticket;
+    pqHeapUnlockSlot(heap, index);
+    bool placed = false;
+    while (placed == false && index > 0) {
+        int parent = (index - 1) / HEAP_ARITY;
+        int locked = index;
+        pqHeapLockSlot(heap, parent);
+        pqHeapLockSlot(heap, index);
+        if (heap->slots[parent].tag == SLOT_AVAILABLE && heap->slots[index].tag == ticket) {
+            PQ_COUNT(insert_traversals, 1);
+            if (pqNodeCompare(heap->nodes[index], heap->nodes[parent], heap->comparePriorities) > 0) {
+                pqHeapSwap(heap, index, parent);
+                index = parent;
+            } else {
+                heap->slots[index].tag = SLOT_AVAILABLE;
+                placed = true;
+            }
+        } else if (heap->slots[parent].tag == SLOT_EMPTY) {
+            placed = true;
+        } else if (heap->slots[index].tag != ticket) {
+            index = parent;
+        }
+        pqHeapUnlockSlot(heap, locked);
+        pqHeapUnlockSlot(heap, parent);
+        if (placed == false && index == locked) {
+            sched_yield();
+        }
+    }
+    if (placed == false) {
+        pqHeapLockSlot(heap, 0);
+        if (heap->slots[0].tag == ticket) {
+            heap->slots[0].tag = SLOT_AVAILABLE;
+        }
+        pqHeapUnlockSlot(heap, 0);
+    }
+}
+
+pqNode pqHeapConcurrentPop(pqHeap heap) {
+    pthread_mutex_lock(&heap->lock);
+    if (heap->size == 0) {
+        pthread_mutex_unlock(&heap->lock);
+        return NULL;
+    }
+    heap->size = heap->size - 1;
+    int bottom = heap->size;
+    pqHeapLockSlot(heap, bottom);
+    pthread_mutex_unlock(&heap->lock);
+    pqNode node = heap->nodes[bottom];
+    heap->slots[bottom].tag = SLOT_EMPTY;
+    pqHeapUnlockSlot(heap, bottom);
+    pqHeapLockSlot(heap, 0);
+    if (heap->slots[0].tag == SLOT_EMPTY ||
+        pqNodeCompare(node, heap->nodes[0], heap->comparePriorities) > 0) {
+        pqHeapUnlockSlot(heap, 0);
+        node->index = NODE_NOT_IN_HEAP;
+        return node;
+    }
+    pqNode top = heap->nodes[0];
+    heap->nodes[0] = node;
+    node->index = 0;
+    heap->slots[0].tag = SLOT_AVAILABLE;
+    int index = 0;
+    while (true) {
+        int best = pqHeapLockBestChild(heap, index);
+        if (best < 0) {
+            break;
+        }
+        if (pqNodeCompare(heap->nodes[best], heap->nodes[index], heap->comparePriorities) <= 0) {
+            pqHeapUnlockSlot(heap, best);
+            break;
+        }
+        pqHeapSwap(heap, index, best);
+        pqHeapUnlockSlot(heap, index);
+        index = best;
+    }
+    pqHeapUnlockSlot(heap, index);
+    top->index = NODE_NOT_IN_HEAP;
+    return top;
+}
+
+int pqHeapGetSize(pqHeap heap) {
+    if (heap == NULL) {
+        return 0;
+    }
+    return heap->size;
+}
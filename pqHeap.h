@@ -0,0 +1,205 @@
+#ifndef EX1_PQHEAP_H
+#define EX1_PQHEAP_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "priority_queue.h"
+#include "pqNode.h"
+
+typedef struct pqHeap_t *pqHeap;
+
+
+/*
+ * STRUCTS
+ */
+
+/**
+ * Struct representing the lock of one position of a concurrent heap, and the tag of the node in it: SLOT_EMPTY when
+ * there is none, SLOT_AVAILABLE when it is in its place, or the ticket of the pqHeapConcurrentPush still moving it up
+ */
+typedef struct pqHeapSlot_t {
+    bool locked;
+    unsigned long tag;
+} pqHeapSlot;
+
+/**
+ * Struct representing an array-backed d-ary heap of nodes. The heap does not own the nodes it holds, it only orders
+ * them, and it keeps every node's position up to date in node->index.
+ * A concurrent heap, see pqHeapMakeConcurrent, also has a slot for each of its capacity positions. lock guards size,
+ * reserved, the positions claimed by pqHeapConcurrentClaim and not pushed yet, and tickets, the next ticket to give a
+ * push
+ */
+struct pqHeap_t {
+    pqNode *nodes;
+    int size;
+    int capacity;
+    ComparePQElementPriorities comparePriorities;
+    pqHeapSlot *slots;
+    int reserved;
+    unsigned long tickets;
+    pthread_mutex_t lock;
+};
+
+/**
+ * pqHeapCreate: Creates a new empty heap
+ * @param compare_priorities - the function used to order the priorities of the nodes
+ * @return
+ *      NULL if memory allocation failed
+ *      the new heap if it didn't
+ */
+pqHeap pqHeapCreate(ComparePQElementPriorities compare_priorities);
+
+/**
+ * pqHeapDestroy: Frees the heap itself, the nodes inside it are not freed
+ * @param heap
+ */
+void pqHeapDestroy(pqHeap heap);
+
+/**
+ * pqHeapReserve: Makes sure the heap can hold capacity nodes without growing
+ * @param heap
+ * @param capacity
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+bool pqHeapReserve(pqHeap heap, int capacity);
+
+/**
+ * pqHeapPush: Adds a node to the heap in O(log n)
+ * @param heap
+ * @param node
+ * @return
+ *      false if memory allocation failed, the heap is unchanged in that case
+ *      true otherwise
+ */
+bool pqHeapPush(pqHeap heap, pqNode node);
+
+/**
+ * pqHeapPushAll: Adds an array of nodes to the heap. When the nodes outnumber the heap, they are appended and the
+ * whole heap is rebuilt bottom-up in O(n), otherwise they are pushed one by one
+ * @param heap
+ * @param nodes
+ * @param count - the amount of nodes in the array
+ * @return
+ *      false if memory allocation failed, the heap is unchanged in that case
+ *      true otherwise
+ */
+bool pqHeapPushAll(pqHeap heap, pqNode *nodes, int count);
+
+/**
+ * pqHeapTop: Retrieve the highest priority node of the heap, ties are broken by the node's sequence
+ * @param heap
+ * @return
+ *      NULL if the heap is empty
+ *      the top node otherwise
+ */
+pqNode pqHeapTop(pqHeap heap);
+
+/**
+ * pqHeapTopK: Retrieve the k highest priority nodes of the heap in order, without changing the heap, in O(k log k).
+ * The heap's nodes are explored from the top through a small heap of candidates, holding the children of the nodes
+ * already taken
+ * @param heap
+ * @param k
+ * @param out - an array of at least k nodes that receives the nodes
+ * @return
+ *      -1 if memory allocation failed
+ *      the amount of nodes written to out otherwise, k or the size of the heap if it is smaller
+ */
+int pqHeapTopK(pqHeap heap, int k, pqNode *out);
+
+/**
+ * pqHeapRemoveAt: Removes the node at a specific position of the heap in O(log n)
+ * @param heap
+ * @param index - the position of the node, as saved in node->index
+ * @return
+ *      NULL if index is out of range
+ *      the removed node otherwise
+ */
+pqNode pqHeapRemoveAt(pqHeap heap, int index);
+
+/**
+ * pqHeapUpdate: Moves the node at a specific position of the heap to its right place after its priority or sequence
+ * has changed, in O(log n)
+ * @param heap
+ * @param index - the position of the node, as saved in node->index
+ */
+void pqHeapUpdate(pqHeap heap, int index);
+
+/**
+ * pqHeapGet: Retrieve the node at a specific position of the heap (the heap's positions are not ordered)
+ * @param heap
+ * @param index
+ * @return
+ *      NULL if index is out of range
+ *      the node otherwise
+ */
+pqNode pqHeapGet(pqHeap heap, int index);
+
+/**
+ * pqHeapMakeConcurrent: Gives the heap a lock for each of its positions, so many threads can push and pop its nodes
+ * at the same time with pqHeapConcurrentPush and pqHeapConcurrentPop. The other functions still need the heap to
+ * themselves, and they keep the slots up to date for the concurrent ones
+ * @param heap
+ * @return
+ *      false if memory allocation failed, the heap is unchanged in that case
+ *      true otherwise
+ */
+bool pqHeapMakeConcurrent(pqHeap heap);
+
+/**
+ * pqHeapIsConcurrent: Checks whether pqHeapMakeConcurrent was called on the heap
+ * @param heap
+ * @return
+ *      true if it was
+ *      false otherwise
+ */
+bool pqHeapIsConcurrent(pqHeap heap);
+
+/**
+ * pqHeapConcurrentClaim: Claims a position of a concurrent heap for a node pqHeapConcurrentPush will push later. The
+ * heap never grows while it is used concurrently, so the claim fails once all its positions are claimed or taken
+ * @param heap
+ * @return
+ *      false if the heap is full, pqHeapReserve can then grow it while no other thread uses it
+ *      true otherwise
+ */
+bool pqHeapConcurrentClaim(pqHeap heap);
+
+/**
+ * pqHeapConcurrentUnclaim: Gives back a position claimed by pqHeapConcurrentClaim that won't be pushed
+ * @param heap
+ */
+void pqHeapConcurrentUnclaim(pqHeap heap);
+
+/**
+ * pqHeapConcurrentPush: Adds a node to a concurrent heap at the position claimed for it, while other threads push and
+ * pop. The node is put at the bottom and moved up one position at a time, holding only the locks of the position and
+ * its parent. Pops may move it up meanwhile, so it is followed by its tag until it is in its place
+ * @param heap
+ * @param node
+ */
+void pqHeapConcurrentPush(pqHeap heap, pqNode node);
+
+/**
+ * pqHeapConcurrentPop: Removes the highest priority node of a concurrent heap, while other threads push and pop.
+ * The bottom node replaces the top one and is moved down one position at a time, holding only the locks of the
+ * position and its children, so pops and pushes work on different parts of the heap at once
+ * @param heap
+ * @return
+ *      NULL if the heap is empty
+ *      the removed node otherwise
+ */
+pqNode pqHeapConcurrentPop(pqHeap heap);
+
+/**
+ * pqHeapGetSize: Retrieve the amount of nodes in the heap
+ * @param heap
+ * @return
+ *      the amount of nodes in the heap
+ */
+int pqHeapGetSize(pqHeap heap);
+
+
+#endif //EX1_PQHEAP_H
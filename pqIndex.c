@@ -0,0 +1,129 @@
+#include "pqIndex.h"
+#include "pqStats.h"
+#include <stdlib.h>
+
+#define INDEX_INITIAL_BUCKETS 16
+#define INDEX_GROWTH_FACTOR 2
+
+/*
+ * STATIC FUNCTIONS FOR pqIndex
+ */
+
+/**
+ * pqIndexBucket: Retrieve the bucket an element belongs to
+ * @param index
+ * @param element
+ * @return
+ *      the position of the element's bucket
+ */
+inline static int pqIndexBucket(pqIndex index, PQElement element) {
+    PQ_COUNT(hash_calls, 1);
+    return (int) (index->hashElement(element) % (unsigned long) index->bucket_count);
+}
+
+/**
+ * pqIndexGrow: Doubles the amount of buckets once there are more nodes than buckets, and rehashes the nodes
+ * @param index
+ */
+static void pqIndexGrow(pqIndex index) {
+    if (index->size < index->bucket_count) {
+        return;
+    }
+    int old_count = index->bucket_count;
+    pqNode *old_buckets = index->buckets;
+    pqNode *new_buckets = calloc(old_count * INDEX_GROWTH_FACTOR, sizeof(*new_buckets));
+    PQ_COUNT_ALLOCATION(new_buckets, old_count * INDEX_GROWTH_FACTOR * sizeof(*new_buckets));
+    if (new_buckets == NULL) {
+        return;
+    }
+    index->buckets = new_buckets;
+    index->bucket_count = old_count * INDEX_GROWTH_FACTOR;
+    for (int i = 0; i < old_count; i++) {
+        pqNode node = old_buckets[i];
+        while (node != NULL) {
+            pqNode next = node->chainNext;
+            int bucket = pqIndexBucket(index, pqNodeGetElement(node));
+            node->chainNext = index->buckets[bucket];
+            index->buckets[bucket] = node;
+            node = next;
+        }
+    }
+    free(old_buckets);
+}
+
+
+/*
+ * FUNCTIONS FOR pqIndex
+ */
+
+pqIndex pqIndexCreate(HashPQElement hash_element, EqualPQElements equal_elements) {
+    pqIndex index = malloc(sizeof(*index));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->buckets = calloc(INDEX_INITIAL_BUCKETS, sizeof(*index->buckets));
+    if (index->buckets == NULL) {
+        free(index);
+        return NULL;
+    }
+    index->bucket_count = INDEX_INITIAL_BUCKETS;
+    index->size = 0;
+    index->hashElement = hash_element;
+    index->equalElements = equal_elements;
+    return index;
+}
+
+void pqIndexDestroy(pqIndex index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->buckets);
+    free(index);
+}
+
+void pqIndexAdd(pqIndex index, pqNode node) {
+    if (index == NULL || node == NULL) {
+        return;
+    }
+    pqIndexGrow(index);
+    int bucket = pqIndexBucket(index, pqNodeGetElement(node));
+    node->chainNext = index->buckets[bucket];
+    index->buckets[bucket] = node;
+    index->size = index->size + 1;
+}
+
+void pqIndexRemove(pqIndex index, pqNode node) {
+    if (index == NULL || node == NULL) {
+        return;
+    }
+    pqNode *link = &index->buckets[pqIndexBucket(index, pqNodeGetElement(node))];
+    while (*link != NULL && *link != node) {
+        link = &(*link)->chainNext;
+    }
+    if (*link == NULL) {
+        return;
+    }
+    *link = node->chainNext;
+    node->chainNext = NULL;
+    index->size = index->size - 1;
+}
+
+pqNode pqIndexFind(pqIndex index, PQElement element, PQElementPriority priority,
+                   ComparePQElementPriorities compare_priorities) {
+    if (index == NULL || element == NULL) {
+        return NULL;
+    }
+    pqNode found = NULL;
+    pqNode node = index->buckets[pqIndexBucket(index, element)];
+    while (node != NULL) {
+        PQ_COUNT(lookup_traversals, 1);
+        PQ_COUNT(equal_calls, 1);
+        if (index->equalElements(element, pqNodeGetElement(node)) &&
+            (priority == NULL || pqNodeHasPriority(node, priority, compare_priorities)) &&
+            (found == NULL || pqNodeCompare(node, found, compare_priorities) > 0)) {
+            found = node;
+        }
+        node = node->chainNext;
+    }
+    return found;
+}
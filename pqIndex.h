@@ -0,0 +1,72 @@
+#ifndef EX1_PQINDEX_H
+#define EX1_PQINDEX_H
+
+#include "priority_queue.h"
+#include "pqNode.h"
+
+typedef struct pqIndex_t *pqIndex;
+
+
+/*
+ * STRUCTS
+ */
+
+/**
+ * Struct representing a hash index from elements to the nodes holding them. Nodes with the same bucket are chained
+ * through node->chainNext, so the index needs no allocation per node
+ */
+struct pqIndex_t {
+    pqNode *buckets;
+    int bucket_count;
+    int size;
+    HashPQElement hashElement;
+    EqualPQElements equalElements;
+};
+
+/**
+ * pqIndexCreate: Creates a new empty index
+ * @param hash_element - the function used to hash elements
+ * @param equal_elements - the function used to identify equal elements
+ * @return
+ *      NULL if memory allocation failed
+ *      the new index if it didn't
+ */
+pqIndex pqIndexCreate(HashPQElement hash_element, EqualPQElements equal_elements);
+
+/**
+ * pqIndexDestroy: Frees the index itself, the nodes inside it are not freed
+ * @param index
+ */
+void pqIndexDestroy(pqIndex index);
+
+/**
+ * pqIndexAdd: Adds a node to the index in O(1) expected time. If growing the index fails the node is still added,
+ * only with longer chains
+ * @param index
+ * @param node
+ */
+void pqIndexAdd(pqIndex index, pqNode node);
+
+/**
+ * pqIndexRemove: Removes a node from the index in O(1) expected time
+ * @param index
+ * @param node
+ */
+void pqIndexRemove(pqIndex index, pqNode node);
+
+/**
+ * pqIndexFind: Finds the highest priority node holding an element equal to element, and a priority equal to priority
+ * (can be set to NULL as to ignore priority)
+ * @param index
+ * @param element
+ * @param priority
+ * @param compare_priorities - the queue's function for comparing priorities
+ * @return
+ *      NULL if no such node exists
+ *      the node otherwise
+ */
+pqNode pqIndexFind(pqIndex index, PQElement element, PQElementPriority priority,
+                   ComparePQElementPriorities compare_priorities);
+
+
+#endif //EX1_PQINDEX_H
@@ -1,48 +1,153 @@
 #include "pqNode.h"
+#include "pqStats.h"
 #include <stdlib.h>
+#include <string.h>
 
+#define POOL_FIRST_CHUNK_CAPACITY 16
+#define POOL_MAX_CHUNK_CAPACITY 4096
 
-pqNode pqNodeIterate(pqNode node, int iterator) {
-    if (node == NULL) {
+/*
+ * STATIC FUNCTIONS FOR pqNodePool
+ */
+
+/**
+ * pqNodePoolAddChunk: Allocates a new chunk of nodes and adds all of its nodes to the free nodes of the pool
+ * @param pool
+ * @param capacity - the amount of nodes in the chunk
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqNodePoolAddChunk(pqNodePool pool, int capacity) {
+    pqNodeChunk chunk = malloc(sizeof(*chunk) + sizeof(struct pqNode_t) * capacity);
+    PQ_COUNT_ALLOCATION(chunk, sizeof(*chunk) + sizeof(struct pqNode_t) * capacity);
+    if (chunk == NULL) {
+        return false;
+    }
+    chunk->capacity = capacity;
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    for (int i = capacity - 1; i >= 0; i--) {
+        chunk->nodes[i].next = pool->free_nodes;
+        pool->free_nodes = &chunk->nodes[i];
+    }
+    pool->free_count = pool->free_count + capacity;
+    return true;
+}
+
+/**
+ * pqNodePoolGrow: Adds a new chunk of nodes to the pool. Every chunk is twice as big as the one before it, up to
+ * POOL_MAX_CHUNK_CAPACITY
+ * @param pool
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqNodePoolGrow(pqNodePool pool) {
+    int capacity = pool->next_chunk_capacity;
+    if (pqNodePoolAddChunk(pool, capacity) == false) {
+        return false;
+    }
+    if (capacity < POOL_MAX_CHUNK_CAPACITY) {
+        pool->next_chunk_capacity = capacity * 2;
+    }
+    return true;
+}
+
+
+pqNodePool pqNodePoolCreate(void) {
+    pqNodePool pool = malloc(sizeof(*pool));
+    if (pool == NULL) {
         return NULL;
     }
-    while (iterator > 1) {
-        node = (pqNode) node->next;
-        return pqNodeIterate(node, iterator - 1);
+    pool->chunks = NULL;
+    pool->free_nodes = NULL;
+    pool->free_count = 0;
+    pool->next_chunk_capacity = POOL_FIRST_CHUNK_CAPACITY;
+    return pool;
+}
+
+void pqNodePoolDestroy(pqNodePool pool) {
+    if (pool == NULL) {
+        return;
+    }
+    while (pool->chunks != NULL) {
+        pqNodeChunk next = pool->chunks->next;
+        free(pool->chunks);
+        pool->chunks = next;
     }
-    return node;
+    free(pool);
 }
 
-pqNode pqNodeCreate(PQElement element, PQElementPriority priority, pqNode next,
-                    CopyPQElement copy_element,
-                    FreePQElement free_element,
-                    CopyPQElementPriority copy_priority,
-                    FreePQElementPriority free_priority) {
-    pqNode node = malloc(sizeof(*node));
-    if (node == NULL) {
+bool pqNodePoolReserve(pqNodePool pool, int count) {
+    if (pool->free_count >= count) {
+        return true;
+    }
+    return pqNodePoolAddChunk(pool, count - pool->free_count);
+}
+
+void pqNodePoolAdopt(pqNodePool pool, pqNodePool other) {
+    if (other->chunks != NULL) {
+        pqNodeChunk last_chunk = other->chunks;
+        while (last_chunk->next != NULL) {
+            last_chunk = last_chunk->next;
+        }
+        last_chunk->next = pool->chunks;
+        pool->chunks = other->chunks;
+    }
+    if (other->free_nodes != NULL) {
+        pqNode last_free = other->free_nodes;
+        while (last_free->next != NULL) {
+            last_free = last_free->next;
+        }
+        last_free->next = pool->free_nodes;
+        pool->free_nodes = other->free_nodes;
+    }
+    pool->free_count = pool->free_count + other->free_count;
+    other->chunks = NULL;
+    other->free_nodes = NULL;
+    other->free_count = 0;
+}
+
+pqNode pqNodeCreate(pqNodePool pool, PQElement element, PQElementPriority priority, pqNode next) {
+    if (pool->free_nodes == NULL && pqNodePoolGrow(pool) == false) {
         return NULL;
     }
+    pqNode node = pool->free_nodes;
+    pool->free_nodes = node->next;
+    pool->free_count = pool->free_count - 1;
     node->element = element;
-    node->priority = priority;
+    node->priority.pointer = priority;
     node->next = next;
-    node->copyElement = copy_element;
-    node->freeElement = free_element;
-    node->copyPriority = copy_priority;
-    node->freePriority = free_priority;
+    node->prev = NULL;
+    node->chainNext = NULL;
+    node->sequence = 0;
+    node->index = NODE_NOT_IN_HEAP;
+    node->dead = false;
     return node;
 }
 
-void pqNodeFree(pqNode node) {
-    if (node == NULL) {
-        return;
-    }
+void pqNodeFreeValues(pqNode node, FreePQElement free_element, FreePQElementPriority free_priority) {
     if (node->element != NULL) {
-        node->freeElement(node->element);
+        PQ_COUNT(free_calls, 1);
+        free_element(node->element);
     }
-    if (node->priority != NULL) {
-        node->freePriority(node->priority);
+    if (free_priority != NULL && node->priority.pointer != NULL) {
+        PQ_COUNT(free_calls, 1);
+        free_priority(node->priority.pointer);
     }
-    free(node);
+}
+
+void pqNodeFree(pqNodePool pool, pqNode node, FreePQElement free_element, FreePQElementPriority free_priority) {
+    if (node == NULL) {
+        return;
+    }
+    pqNodeFreeValues(node, free_element, free_priority);
+    node->element = NULL;
+    node->priority.pointer = NULL;
+    node->next = pool->free_nodes;
+    pool->free_nodes = node;
+    pool->free_count = pool->free_count + 1;
 }
 
 inline PQElement pqNodeGetElement(pqNode node) {
@@ -56,7 +161,7 @@ inline PQElementPriority pqNodeGetPriority(pqNode node) {
     if (node == NULL) {
         return NULL;
     }
-    return node->priority;
+    return node->priority.pointer;
 }
 
 inline pqNode pqNodeGetNext(pqNode node) {
@@ -66,29 +171,94 @@ inline pqNode pqNodeGetNext(pqNode node) {
     return node->next;
 }
 
-pqNode pqNodeCopy(pqNode node) {
+pqNode pqNodeCopy(pqNodePool pool, pqNode node, CopyPQElement copy_element, CopyPQElementPriority copy_priority) {
     if (node == NULL) {
         return NULL;
     }
-    pqNode new_node = pqNodeCreate(node->copyElement(pqNodeGetElement(node)),
-                                   node->copyPriority(pqNodeGetPriority(node)),
-                                   pqNodeGetNext(node),
-                                   node->copyElement, node->freeElement,
-                                   node->copyPriority, node->freePriority);
+    PQ_COUNT(copy_calls, 1);
+    PQElement element = copy_element(pqNodeGetElement(node));
+    pqNode new_node = pqNodeCreate(pool, element, NULL, pqNodeGetNext(node));
     if (new_node == NULL) {
         return NULL;
     }
+    if (copy_priority == NULL) {
+        new_node->priority = node->priority;
+    } else {
+        PQ_COUNT(copy_calls, 1);
+        new_node->priority.pointer = copy_priority(pqNodeGetPriority(node));
+    }
+    new_node->sequence = node->sequence;
     return new_node;
 }
 
-pqNode pqNodeCopyFull(pqNode node) {
-    if (node == NULL) {
-        return NULL;
+int pqNodeComparePriorities(pqNode first, pqNode second, ComparePQElementPriorities compare_priorities) {
+    PQ_COUNT(comparisons, 1);
+    if (compare_priorities != NULL) {
+        PQ_COUNT(compare_calls, 1);
+        return compare_priorities(pqNodeGetPriority(first), pqNodeGetPriority(second));
     }
-    pqNode new_node = pqNodeCopy(node);
-    if (new_node == NULL) {
-        return NULL;
+    if (first->priority.scalar == second->priority.scalar) {
+        return 0;
     }
-    new_node->next = pqNodeCopyFull(pqNodeGetNext(node));
-    return new_node;
+    return first->priority.scalar < second->priority.scalar ? 1 : -1;
+}
+
+bool pqNodeHasPriority(pqNode node, PQElementPriority priority, ComparePQElementPriorities compare_priorities) {
+    PQ_COUNT(comparisons, 1);
+    if (compare_priorities != NULL) {
+        PQ_COUNT(compare_calls, 1);
+        return compare_priorities(priority, pqNodeGetPriority(node)) == 0;
+    }
+    return *(PQScalarPriority *) priority == node->priority.scalar;
+}
+
+int pqNodeCompare(pqNode first, pqNode second, ComparePQElementPriorities compare_priorities) {
+    int priority_compare = pqNodeComparePriorities(first, second, compare_priorities);
+    if (priority_compare != 0) {
+        return priority_compare;
+    }
+    if (first->sequence == second->sequence) {
+        return 0;
+    }
+    return first->sequence < second->sequence ? 1 : -1;
+}
+
+bool pqNodeSort(pqNode *nodes, int count, ComparePQElementPriorities compare_priorities) {
+    if (count < 2) {
+        return true;
+    }
+    pqNode *buffer = malloc(sizeof(*buffer) * count);
+    PQ_COUNT_ALLOCATION(buffer, sizeof(*buffer) * count);
+    if (buffer == NULL) {
+        return false;
+    }
+    pqNode *from = nodes, *to = buffer;
+    for (int width = 1; width < count; width = width * 2) {
+        for (int start = 0; start < count; start = start + 2 * width) {
+            int middle = start + width < count ? start + width : count;
+            int end = start + 2 * width < count ? start + 2 * width : count;
+            int left = start, right = middle, out = start;
+            while (left < middle && right < end) {
+                if (pqNodeCompare(from[right], from[left], compare_priorities) > 0) {
+                    to[out++] = from[right++];
+                } else {
+                    to[out++] = from[left++];
+                }
+            }
+            while (left < middle) {
+                to[out++] = from[left++];
+            }
+            while (right < end) {
+                to[out++] = from[right++];
+            }
+        }
+        pqNode *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != nodes) {
+        memcpy(nodes, from, sizeof(*nodes) * count);
+    }
+    free(buffer);
+    return true;
 }
@@ -1,9 +1,14 @@
 #ifndef EX1_PQNODE_H
 #define EX1_PQNODE_H
 
+#include <stdbool.h>
 #include "priority_queue.h"
 
 typedef struct pqNode_t *pqNode;
+typedef struct pqNodeChunk_t *pqNodeChunk;
+typedef struct pqNodePool_t *pqNodePool;
+
+#define NODE_NOT_IN_HEAP -1
 
 
 /*
@@ -11,49 +16,115 @@ typedef struct pqNode_t *pqNode;
  */
 
 /**
- * Struct representing a single node inside the queue
+ * Union representing the priority of a node: a copy of the user's priority, or the priority itself in a scalar queue
+ */
+typedef union pqNodePriority_t {
+    PQElementPriority *pointer;
+    PQScalarPriority scalar;
+} pqNodePriority;
+
+/**
+ * Struct representing a single node inside the queue. The functions for copying and freeing the element and the
+ * priority are the queue's, so they are not kept in every node.
+ * A node removed from a queue in lazy deletion mode is a tombstone: it is dead, its element was already freed, and it
+ * stays in the queue with its priority until it is compacted away.
+ * In all the functions below, a NULL priority function means the node belongs to a scalar queue
  */
 struct pqNode_t {
     PQElement *element;
-    PQElementPriority *priority;
-    CopyPQElement copyElement;
-    FreePQElement freeElement;
-    CopyPQElementPriority copyPriority;
-    FreePQElementPriority freePriority;
+    pqNodePriority priority;
     pqNode next;
+    pqNode prev;
+    pqNode chainNext;
+    unsigned long sequence;
+    int index;
+    bool dead;
+};
+
+/**
+ * Struct representing a chunk of nodes allocated at once
+ */
+struct pqNodeChunk_t {
+    pqNodeChunk next;
+    int capacity;
+    struct pqNode_t nodes[];
+};
+
+/**
+ * Struct representing a pool the nodes of a queue are taken from. Nodes are allocated in chunks that grow as the pool
+ * grows, and freed nodes are kept in free_nodes, linked through node->next, until they are reused
+ */
+struct pqNodePool_t {
+    pqNodeChunk chunks;
+    pqNode free_nodes;
+    int free_count;
+    int next_chunk_capacity;
 };
 
 /**
- * pqNodeIterator: Goes over the number of nodes the iterator points to, recursively
- * @param node - first node, iterating down from there
- * @param iterator - the number of nodes to go down to
+ * pqNodePoolCreate: Creates a new empty pool of nodes
+ * @return
+ *      NULL if memory allocation failed
+ *      the new pool if it didn't
+ */
+pqNodePool pqNodePoolCreate(void);
+
+/**
+ * pqNodePoolDestroy: Frees the pool and all of its chunks at once. The elements and priorities of nodes still in use
+ * are not freed
+ * @param pool
+ */
+void pqNodePoolDestroy(pqNodePool pool);
+
+/**
+ * pqNodePoolReserve: Makes sure the pool has at least count free nodes, allocating all the missing nodes in a single
+ * chunk
+ * @param pool
+ * @param count
  * @return
- *      if the iterator reached 0, the node that it stopped on will be returned
- *      otherwise, pqNodeIterate with the next node and iterator -1
+ *      false if memory allocation failed
+ *      true otherwise
  */
-pqNode pqNodeIterate(pqNode node, int iterator);
+bool pqNodePoolReserve(pqNodePool pool, int count);
 
 /**
- * pqNodeCreate: Creates a new node with provided element, priority and next, each of them can be set to NULL
+ * pqNodePoolAdopt: Moves all the chunks of another pool into the pool, with the nodes taken from them and their free
+ * nodes, so nodes taken from other now belong to pool. other is left empty
+ * @param pool
+ * @param other
+ */
+void pqNodePoolAdopt(pqNodePool pool, pqNodePool other);
+
+/**
+ * pqNodeCreate: Takes a new node from the pool with provided element, priority and next, each of them can be set to
+ * NULL
+ * @param pool - the pool of the queue the node belongs to
  * @param element
  * @param priority
  * @param next
- * @param queue - the queue we're using in order to get queue functions
  * @return
  *      NULL if memory allocation failed
  *      the new node if it didn't
  */
-pqNode pqNodeCreate(PQElement element, PQElementPriority priority, pqNode next,
-                    CopyPQElement copy_element,
-                    FreePQElement free_element,
-                    CopyPQElementPriority copy_priority,
-                    FreePQElementPriority free_priority);
+pqNode pqNodeCreate(pqNodePool pool, PQElement element, PQElementPriority priority, pqNode next);
+
+/**
+ * pqNodeFreeValues: Free the element and priority of the specific node, without returning the node to the pool. Used
+ * when all the nodes of a pool are released together with pqNodePoolDestroy
+ * @param node
+ * @param free_element - the queue's function for freeing elements
+ * @param free_priority - the queue's function for freeing priorities, NULL if the priority is not to be freed
+ */
+void pqNodeFreeValues(pqNode node, FreePQElement free_element, FreePQElementPriority free_priority);
 
 /**
- * pqNodeFree: Free the element, priority of the specific node and free node itself
+ * pqNodeFree: Free the element, priority of the specific node and return the node itself to the pool
+ * @param pool - the pool of the queue the node belongs to
  * @param node
+ * @param free_element - the queue's function for freeing elements
+ * @param free_priority - the queue's function for freeing priorities
  */
-void pqNodeFree(pqNode node);
+void pqNodeFree(pqNodePool pool, pqNode node, FreePQElement free_element, FreePQElementPriority free_priority);
 
 /**
  * pqNodeGetElement: Retrieve the element from current node
@@ -64,10 +135,10 @@ void pqNodeFree(pqNode node);
 PQElement pqNodeGetElement(pqNode node);
 
 /**
- * pqNodeGetPriority: Retrieve the priority from the current node
+ * pqNodeGetPriority: Retrieve the priority from the current node, for nodes that are not of a scalar queue
  * @param node - the node whose priority the function returns
  * @return
- *      node->priority
+ *      node->priority.pointer
  */
 PQElementPriority pqNodeGetPriority(pqNode node);
 
@@ -81,23 +152,62 @@ pqNode pqNodeGetNext(pqNode node);
 
 /**
  * pqNodeCopy: Creates a copy of a single node
+ * @param pool - the pool of the queue the copy belongs to
  * @param node
- * @param queue - the queue we're using in order to get queue functions
+ * @param copy_element - the queue's function for copying elements
+ * @param copy_priority - the queue's function for copying priorities
  * @return
  *      NULL if the node wasn't successfully created
  *      the new node otherwise
 */
-pqNode pqNodeCopy(pqNode node);
+pqNode pqNodeCopy(pqNodePool pool, pqNode node, CopyPQElement copy_element, CopyPQElementPriority copy_priority);
+
+
+/**
+ * pqNodeComparePriorities: Compares the priorities of two nodes, a lower scalar priority is a higher priority
+ * @param first
+ * @param second
+ * @param compare_priorities - the queue's function for comparing priorities
+ * @return
+ *      A positive integer if the priority of first is higher;
+ *      0 if they're equal;
+ *      A negative integer if the priority of second is higher.
+ */
+int pqNodeComparePriorities(pqNode first, pqNode second, ComparePQElementPriorities compare_priorities);
 
 /**
- * pqNodeCopyFull: Creates a copy of all linked nodes, recursively
+ * pqNodeHasPriority: Checks if the priority of a node is equal to a priority given by the user
  * @param node
- * @param queue - the queue we're using in order to get queue functions
+ * @param priority - a priority as given to the queue's functions
+ * @param compare_priorities - the queue's function for comparing priorities
+ * @return
+ *      TRUE if the priorities are equal
+ *      FALSE otherwise
+ */
+bool pqNodeHasPriority(pqNode node, PQElementPriority priority, ComparePQElementPriorities compare_priorities);
+
+/**
+ * pqNodeCompare: Compares the order of two nodes by priority, and by insertion sequence between equal priorities
+ * @param first
+ * @param second
+ * @param compare_priorities - the queue's function for comparing priorities
+ * @return
+ *      A positive integer if first comes before second;
+ *      0 if they're the same node;
+ *      A negative integer if second comes before first.
+ */
+int pqNodeCompare(pqNode first, pqNode second, ComparePQElementPriorities compare_priorities);
+
+/**
+ * pqNodeSort: Sorts an array of nodes from first to last according to pqNodeCompare
+ * @param nodes
+ * @param count - the amount of nodes in the array
+ * @param compare_priorities - the queue's function for comparing priorities
  * @return
- *      NULL if the node(s) weren't successfully created
- *      the new copied top of the node (I hope)
+ *      false if memory allocation failed, the array is unchanged in that case
+ *      true otherwise
  */
-pqNode pqNodeCopyFull(pqNode node);
+bool pqNodeSort(pqNode *nodes, int count, ComparePQElementPriorities compare_priorities);
 
 
 #endif //EX1_PQNODE_H
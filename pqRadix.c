@@ -0,0 +1,253 @@
+#include "pqRadix.h"
+#include "pqStats.h"
+#include <stdlib.h>
+
+#define SIGN_BIT ((uint64_t) 1 << 63)
+
+/*
+ * STATIC FUNCTIONS FOR pqRadix
+ */
+
+/**
+ * pqRadixKey: Retrieve the priority of a node as an unsigned key of the same order, a lower key is a higher priority
+ * @param node
+ * @return
+ *      the key of the node
+ */
+inline static uint64_t pqRadixKey(pqNode node) {
+    return (uint64_t) node->priority.scalar ^ SIGN_BIT;
+}
+
+/**
+ * pqRadixBucket: Retrieve the bucket of a key, one more than the highest bit in which it differs from the minimum
+ * @param radix
+ * @param key
+ * @return
+ *      0 if the key is the minimum
+ *      the bucket of the key otherwise
+ */
+static int pqRadixBucket(pqRadix radix, uint64_t key) {
+    uint64_t difference = key ^ radix->minimum;
+    if (difference == 0) {
+        return 0;
+    }
+    int bucket = 1;
+    for (int shift = 32; shift > 0; shift = shift / 2) {
+        if (difference >> shift != 0) {
+            difference = difference >> shift;
+            bucket = bucket + shift;
+        }
+    }
+    return bucket;
+}
+
+/**
+ * pqRadixAppend: Links a node at the end of a bucket
+ * @param radix
+ * @param node
+ * @param bucket
+ */
+static void pqRadixAppend(pqRadix radix, pqNode node, int bucket) {
+    node->index = bucket;
+    node->next = NULL;
+    node->prev = radix->last[bucket];
+    if (radix->last[bucket] == NULL) {
+        radix->first[bucket] = node;
+    } else {
+        radix->last[bucket]->next = node;
+    }
+    radix->last[bucket] = node;
+}
+
+/**
+ * pqRadixUnlink: Unlinks a node from its bucket
+ * @param radix
+ * @param node
+ */
+static void pqRadixUnlink(pqRadix radix, pqNode node) {
+    if (node->prev == NULL) {
+        radix->first[node->index] = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+    if (node->next == NULL) {
+        radix->last[node->index] = node->prev;
+    } else {
+        node->next->prev = node->prev;
+    }
+}
+
+/**
+ * pqRadixRedistribute: Moves a chain of nodes, linked through node->next, to their buckets in the order of the
+ * chain. Nodes of equal priority are always in the same bucket, so they keep their order
+ * @param radix
+ * @param node - the first node of the chain
+ */
+static void pqRadixRedistribute(pqRadix radix, pqNode node) {
+    while (node != NULL) {
+        pqNode next = node->next;
+        pqRadixAppend(radix, node, pqRadixBucket(radix, pqRadixKey(node)));
+        node = next;
+    }
+}
+
+/**
+ * pqRadixRebuild: Places all the nodes in new buckets, around a new minimum below all of them
+ * @param radix
+ * @param minimum
+ */
+static void pqRadixRebuild(pqRadix radix, uint64_t minimum) {
+    pqNode chain = NULL, chain_last = NULL;
+    for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+        if (radix->first[bucket] == NULL) {
+            continue;
+        }
+        if (chain_last == NULL) {
+            chain = radix->first[bucket];
+        } else {
+            chain_last->next = radix->first[bucket];
+        }
+        chain_last = radix->last[bucket];
+        radix->first[bucket] = NULL;
+        radix->last[bucket] = NULL;
+    }
+    radix->minimum = minimum;
+    pqRadixRedistribute(radix, chain);
+}
+
+
+/*
+ * FUNCTIONS FOR pqRadix
+ */
+
+pqRadix pqRadixCreate(void) {
+    pqRadix radix = malloc(sizeof(*radix));
+    if (radix == NULL) {
+        return NULL;
+    }
+    for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+        radix->first[bucket] = NULL;
+        radix->last[bucket] = NULL;
+    }
+    radix->minimum = 0;
+    radix->size = 0;
+    radix->rebuilds = 0;
+    return radix;
+}
+
+void pqRadixDestroy(pqRadix radix) {
+    free(radix);
+}
+
+void pqRadixPush(pqRadix radix, pqNode node) {
+    uint64_t key = pqRadixKey(node);
+    if (radix->size == 0) {
+        radix->minimum = key;
+    } else if (key < radix->minimum) {
+        pqRadixRebuild(radix, key);
+        radix->rebuilds = radix->rebuilds + 1;
+    }
+    pqRadixAppend(radix, node, pqRadixBucket(radix, key));
+    radix->size = radix->size + 1;
+}
+
+pqNode pqRadixTop(pqRadix radix) {
+    if (radix == NULL || radix->size == 0) {
+        return NULL;
+    }
+    if (radix->first[0] == NULL) {
+        int bucket = 1;
+        while (radix->first[bucket] == NULL) {
+            bucket = bucket + 1;
+        }
+        uint64_t minimum = pqRadixKey(radix->first[bucket]);
+        for (pqNode node = radix->first[bucket]; node != NULL; node = node->next) {
+            if (pqRadixKey(node) < minimum) {
+                minimum = pqRadixKey(node);
+            }
+        }
+        pqNode chain = radix->first[bucket];
+        radix->first[bucket] = NULL;
+        radix->last[bucket] = NULL;
+        radix->minimum = minimum;
+        pqRadixRedistribute(radix, chain);
+    }
+    return radix->first[0];
+}
+
+int pqRadixTopK(pqRadix radix, int k, pqNode *out) {
+    if (k > radix->size) {
+        k = radix->size;
+    }
+    int count = 0;
+    for (int bucket = 0; bucket < RADIX_BUCKETS && count < k; bucket++) {
+        int bucket_size = 0;
+        for (pqNode node = radix->first[bucket]; node != NULL; node = node->next) {
+            bucket_size = bucket_size + 1;
+        }
+        if (bucket_size == 0) {
+            continue;
+        }
+        pqNode *nodes = malloc(sizeof(*nodes) * bucket_size);
+        PQ_COUNT_ALLOCATION(nodes, sizeof(*nodes) * bucket_size);
+        if (nodes == NULL) {
+            return -1;
+        }
+        int i = 0;
+        for (pqNode node = radix->first[bucket]; node != NULL; node = node->next) {
+            nodes[i] = node;
+            i = i + 1;
+        }
+        if (pqNodeSort(nodes, bucket_size, NULL) == false) {
+            free(nodes);
+            return -1;
+        }
+        for (i = 0; i < bucket_size && count < k; i++) {
+            out[count] = nodes[i];
+            count = count + 1;
+        }
+        free(nodes);
+    }
+    return count;
+}
+
+void pqRadixRemove(pqRadix radix, pqNode node) {
+    pqRadixUnlink(radix, node);
+    node->next = NULL;
+    node->prev = NULL;
+    node->index = NODE_NOT_IN_HEAP;
+    radix->size = radix->size - 1;
+}
+
+void pqRadixUpdate(pqRadix radix, pqNode node) {
+    pqRadixRemove(radix, node);
+    pqRadixPush(radix, node);
+}
+
+pqNode pqRadixFirst(pqRadix radix) {
+    for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+        if (radix->first[bucket] != NULL) {
+            return radix->first[bucket];
+        }
+    }
+    return NULL;
+}
+
+pqNode pqRadixNext(pqRadix radix, pqNode node) {
+    if (node->next != NULL) {
+        return node->next;
+    }
+    for (int bucket = node->index + 1; bucket < RADIX_BUCKETS; bucket++) {
+        if (radix->first[bucket] != NULL) {
+            return radix->first[bucket];
+        }
+    }
+    return NULL;
+}
+
+int pqRadixGetSize(pqRadix radix) {
+    if (radix == NULL) {
+        return 0;
+    }
+    return radix->size;
+}
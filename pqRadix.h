@@ -0,0 +1,125 @@
+#ifndef EX1_PQRADIX_H
+#define EX1_PQRADIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "priority_queue.h"
+#include "pqNode.h"
+
+typedef struct pqRadix_t *pqRadix;
+
+/** One bucket for keys equal to the minimum, and one for every bit a key can first differ from it in */
+#define RADIX_BUCKETS 65
+
+
+/*
+ * STRUCTS
+ */
+
+/**
+ * Struct representing a radix heap of the nodes of a scalar queue. A node's bucket is decided by the highest bit in
+ * which its priority differs from minimum, the last priority taken from the top, so every bucket holds a range of
+ * priorities that is above the ranges of the buckets before it. Bucket 0 holds the nodes whose priority is minimum.
+ * The nodes of every bucket are linked through node->next and node->prev in the order they were added, and
+ * node->index is the node's bucket. Like the heap, the radix heap does not own the nodes it holds.
+ * A priority below minimum can't be placed in a bucket, so the whole radix heap is rebuilt around it, rebuilds
+ * counts these rebuilds
+ */
+struct pqRadix_t {
+    pqNode first[RADIX_BUCKETS];
+    pqNode last[RADIX_BUCKETS];
+    uint64_t minimum;
+    int size;
+    unsigned long rebuilds;
+};
+
+/**
+ * pqRadixCreate: Creates a new empty radix heap
+ * @return
+ *      NULL if memory allocation failed
+ *      the new radix heap if it didn't
+ */
+pqRadix pqRadixCreate(void);
+
+/**
+ * pqRadixDestroy: Frees the radix heap itself, the nodes inside it are not freed
+ * @param radix
+ */
+void pqRadixDestroy(pqRadix radix);
+
+/**
+ * pqRadixPush: Adds a node to the radix heap in O(1). A node whose priority is below the last priority taken from
+ * the top rebuilds the radix heap in O(n) instead
+ * @param radix
+ * @param node
+ */
+void pqRadixPush(pqRadix radix, pqNode node);
+
+/**
+ * pqRadixTop: Retrieve the highest priority node of the radix heap, ties are broken by the node's sequence. When
+ * bucket 0 is empty, the first bucket that isn't is split between the buckets below it, so the nodes only move down
+ * and this is O(1) amortized while priorities don't go backwards
+ * @param radix
+ * @return
+ *      NULL if the radix heap is empty
+ *      the top node otherwise
+ */
+pqNode pqRadixTop(pqRadix radix);
+
+/**
+ * pqRadixTopK: Retrieve the k highest priority nodes of the radix heap in order, without changing the radix heap.
+ * The buckets are taken in order, and each bucket is sorted on its own
+ * @param radix
+ * @param k
+ * @param out - an array of at least k nodes that receives the nodes
+ * @return
+ *      -1 if memory allocation failed
+ *      the amount of nodes written to out otherwise, k or the size of the radix heap if it is smaller
+ */
+int pqRadixTopK(pqRadix radix, int k, pqNode *out);
+
+/**
+ * pqRadixRemove: Removes a node from the radix heap in O(1)
+ * @param radix
+ * @param node
+ */
+void pqRadixRemove(pqRadix radix, pqNode node);
+
+/**
+ * pqRadixUpdate: Moves a node to its right place after its priority or sequence has changed, in O(1) unless its new
+ * priority is below the last priority taken from the top
+ * @param radix
+ * @param node
+ */
+void pqRadixUpdate(pqRadix radix, pqNode node);
+
+/**
+ * pqRadixFirst: Retrieve the first node of the radix heap in the order of its buckets, for walking all the nodes
+ * with pqRadixNext. This is not the order of the queue
+ * @param radix
+ * @return
+ *      NULL if the radix heap is empty
+ *      the first node otherwise
+ */
+pqNode pqRadixFirst(pqRadix radix);
+
+/**
+ * pqRadixNext: Retrieve the node after node in the order of the buckets
+ * @param radix
+ * @param node
+ * @return
+ *      NULL if node is the last node
+ *      the next node otherwise
+ */
+pqNode pqRadixNext(pqRadix radix, pqNode node);
+
+/**
+ * pqRadixGetSize: Retrieve the amount of nodes in the radix heap
+ * @param radix
+ * @return
+ *      the amount of nodes in the radix heap
+ */
+int pqRadixGetSize(pqRadix radix);
+
+
+#endif //EX1_PQRADIX_H
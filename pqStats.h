@@ -0,0 +1,53 @@
+#ifndef EX1_PQSTATS_H
+#define EX1_PQSTATS_H
+
+#include "priority_queue.h"
+
+/*
+ * The counters of a queue are only kept when the library is compiled with PQ_STATS defined. While a thread holds the
+ * lock of a queue, pq_counters points to the counters of that queue, so the nodes, heaps, indexes and buckets below it
+ * count their work without knowing which queue it is done for. The counters are added to atomically, since the
+ * threads reading a concurrent queue share its lock, as do the threads inserting into and popping from a concurrent
+ * heap.
+ * Without PQ_STATS, the macros expand to nothing and their arguments are never evaluated.
+ */
+#ifdef PQ_STATS
+
+extern __thread PQCounters *pq_counters;
+
+/**
+ * PQ_COUNT_INTO: Adds amount to one of the counters pointed to by counters, if it isn't NULL
+ */
+#define PQ_COUNT_INTO(counters, counter, amount) \
+    do { \
+        PQCounters *pq_count_target = (counters); \
+        if (pq_count_target != NULL) { \
+            __atomic_fetch_add(&pq_count_target->counter, (unsigned long) (amount), __ATOMIC_RELAXED); \
+        } \
+    } while (0)
+
+/**
+ * PQ_COUNT_ALLOCATION: Counts an allocation of bytes bytes, if it succeeded
+ */
+#define PQ_COUNT_ALLOCATION(pointer, bytes) \
+    do { \
+        if ((pointer) != NULL) { \
+            PQ_COUNT(allocations, 1); \
+            PQ_COUNT(allocated_bytes, bytes); \
+        } \
+    } while (0)
+
+#else
+
+#define PQ_COUNT_INTO(counters, counter, amount) ((void) 0)
+#define PQ_COUNT_ALLOCATION(pointer, bytes) ((void) 0)
+
+#endif
+
+/**
+ * PQ_COUNT: Adds amount to one of the counters of the queue the calling thread is working on
+ */
+#define PQ_COUNT(counter, amount) PQ_COUNT_INTO(pq_counters, counter, amount)
+
+
+#endif //EX1_PQSTATS_H
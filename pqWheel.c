@@ -0,0 +1,393 @@
+#include "pqWheel.h"
+#include "pqStats.h"
+#include <stdlib.h>
+
+#define SIGN_BIT ((uint64_t) 1 << 63)
+#define NO_SLOT -1
+
+/*
+ * STATIC FUNCTIONS FOR pqWheel
+ */
+
+/**
+ * pqWheelKey: Retrieve the priority of a node as an unsigned key of the same order, a lower key is a higher priority
+ * @param node
+ * @return
+ *      the key of the node
+ */
+inline static uint64_t pqWheelKey(pqNode node) {
+    return (uint64_t) node->priority.scalar ^ SIGN_BIT;
+}
+
+/**
+ * pqWheelBefore: Checks whether a node comes before another in the order of the queue, ties are broken by the nodes'
+ * sequences
+ * @param first
+ * @param second
+ * @return
+ *      true if first comes before second
+ *      false otherwise
+ */
+inline static bool pqWheelBefore(pqNode first, pqNode second) {
+    PQ_COUNT(comparisons, 1);
+    return pqWheelKey(first) < pqWheelKey(second) ||
+           (pqWheelKey(first) == pqWheelKey(second) && first->sequence < second->sequence);
+}
+
+/**
+ * pqWheelHighestBit: Retrieve the position of the highest bit set in bits, which must not be 0
+ * @param bits
+ * @return
+ *      the position of the bit, from 0 to 63
+ */
+static int pqWheelHighestBit(uint64_t bits) {
+    int position = 0;
+    for (int shift = 32; shift > 0; shift = shift / 2) {
+        if (bits >> shift != 0) {
+            bits = bits >> shift;
+            position = position + shift;
+        }
+    }
+    return position;
+}
+
+/**
+ * pqWheelLowestBit: Retrieve the position of the lowest bit set in bits, which must not be 0
+ * @param bits
+ * @return
+ *      the position of the bit, from 0 to 63
+ */
+static int pqWheelLowestBit(uint64_t bits) {
+    return pqWheelHighestBit(bits & (~bits + 1));
+}
+
+/**
+ * pqWheelSlot: Retrieve the slot of a key: the level is the highest digit in which the key differs from now, and the
+ * slot in that level is the key's value of that digit
+ * @param wheel
+ * @param key
+ * @return
+ *      the slot of the key, counted over all the levels
+ */
+static int pqWheelSlot(pqWheel wheel, uint64_t key) {
+    uint64_t difference = key ^ wheel->now;
+    int level = difference == 0 ? 0 : pqWheelHighestBit(difference) / WHEEL_SLOT_BITS;
+    return level * WHEEL_SLOTS + (int) ((key >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1));
+}
+
+/**
+ * pqWheelFirstSlotFrom: Finds the first slot that isn't empty, starting from a certain slot
+ * @param wheel
+ * @param slot
+ * @return
+ *      NO_SLOT if all the slots from slot on are empty
+ *      the slot otherwise
+ */
+static int pqWheelFirstSlotFrom(pqWheel wheel, int slot) {
+    for (int level = slot / WHEEL_SLOTS; level < WHEEL_LEVELS; level++) {
+        uint64_t bits = wheel->occupied[level];
+        if (level == slot / WHEEL_SLOTS) {
+            bits = bits & (~(uint64_t) 0 << (slot % WHEEL_SLOTS));
+        }
+        if (bits != 0) {
+            return level * WHEEL_SLOTS + pqWheelLowestBit(bits);
+        }
+    }
+    return NO_SLOT;
+}
+
+/**
+ * pqWheelAppend: Links a node at the end of a slot, the slot stays sorted if the node comes after all of its nodes
+ * @param wheel
+ * @param node
+ * @param slot
+ */
+static void pqWheelAppend(pqWheel wheel, pqNode node, int slot) {
+    uint64_t bit = (uint64_t) 1 << (slot % WHEEL_SLOTS);
+    node->index = slot;
+    node->next = NULL;
+    node->prev = wheel->last[slot];
+    if (wheel->last[slot] == NULL) {
+        wheel->first[slot] = node;
+        wheel->occupied[slot / WHEEL_SLOTS] |= bit;
+        wheel->sorted[slot / WHEEL_SLOTS] |= bit;
+    } else {
+        if ((wheel->sorted[slot / WHEEL_SLOTS] & bit) != 0 && pqWheelBefore(node, wheel->last[slot])) {
+            wheel->sorted[slot / WHEEL_SLOTS] &= ~bit;
+        }
+        wheel->last[slot]->next = node;
+    }
+    wheel->last[slot] = node;
+}
+
+/**
+ * pqWheelTake: Empties a slot, keeping its nodes linked through node->next
+ * @param wheel
+ * @param slot
+ * @return
+ *      the first node of the slot
+ */
+static pqNode pqWheelTake(pqWheel wheel, int slot) {
+    pqNode chain = wheel->first[slot];
+    wheel->first[slot] = NULL;
+    wheel->last[slot] = NULL;
+    wheel->occupied[slot / WHEEL_SLOTS] &= ~((uint64_t) 1 << (slot % WHEEL_SLOTS));
+    return chain;
+}
+
+/**
+ * pqWheelUnlink: Unlinks a node from its slot
+ * @param wheel
+ * @param node
+ */
+static void pqWheelUnlink(pqWheel wheel, pqNode node) {
+    if (node->prev == NULL) {
+        wheel->first[node->index] = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+    if (node->next == NULL) {
+        wheel->last[node->index] = node->prev;
+    } else {
+        node->next->prev = node->prev;
+    }
+    if (wheel->first[node->index] == NULL) {
+        wheel->occupied[node->index / WHEEL_SLOTS] &= ~((uint64_t) 1 << (node->index % WHEEL_SLOTS));
+    }
+}
+
+/**
+ * pqWheelMerge: Merges two chains of nodes sorted in the order of the queue, linked through node->next, into one
+ * @param first
+ * @param second
+ * @return
+ *      the first node of the merged chain
+ */
+static pqNode pqWheelMerge(pqNode first, pqNode second) {
+    pqNode merged = NULL;
+    pqNode *tail = &merged;
+    while (first != NULL && second != NULL) {
+        if (pqWheelBefore(second, first)) {
+            *tail = second;
+            second = second->next;
+        } else {
+            *tail = first;
+            first = first->next;
+        }
+        tail = &(*tail)->next;
+    }
+    *tail = first != NULL ? first : second;
+    return merged;
+}
+
+/**
+ * pqWheelSortChain: Sorts a chain of count nodes linked through node->next by merge sort, without allocating
+ * @param chain - the first node of the chain, whose last node's next is NULL
+ * @param count
+ * @return
+ *      the first node of the sorted chain
+ */
+static pqNode pqWheelSortChain(pqNode chain, int count) {
+    if (count <= 1) {
+        return chain;
+    }
+    pqNode middle = chain;
+    for (int i = 1; i < count / 2; i++) {
+        middle = middle->next;
+    }
+    pqNode second = middle->next;
+    middle->next = NULL;
+    return pqWheelMerge(pqWheelSortChain(chain, count / 2), pqWheelSortChain(second, count - count / 2));
+}
+
+/**
+ * pqWheelSortSlot: Links the nodes of a slot in the order of the queue, unless they already are. The nodes of a
+ * sorted slot that were appended after it was sorted follow a sorted prefix, so only they are sorted, and then merged
+ * with the prefix
+ * @param wheel
+ * @param slot
+ */
+static void pqWheelSortSlot(pqWheel wheel, int slot) {
+    uint64_t bit = (uint64_t) 1 << (slot % WHEEL_SLOTS);
+    if ((wheel->sorted[slot / WHEEL_SLOTS] & bit) != 0) {
+        return;
+    }
+    pqNode prefix_last = wheel->first[slot];
+    while (prefix_last->next != NULL && pqWheelBefore(prefix_last->next, prefix_last) == false) {
+        prefix_last = prefix_last->next;
+    }
+    pqNode rest = prefix_last->next;
+    prefix_last->next = NULL;
+    int count = 0;
+    for (pqNode node = rest; node != NULL; node = node->next) {
+        count = count + 1;
+    }
+    pqNode chain = pqWheelMerge(wheel->first[slot], pqWheelSortChain(rest, count));
+    pqNode prev = NULL;
+    for (pqNode node = chain; node != NULL; node = node->next) {
+        node->prev = prev;
+        prev = node;
+    }
+    wheel->first[slot] = chain;
+    wheel->last[slot] = prev;
+    wheel->sorted[slot / WHEEL_SLOTS] |= bit;
+}
+
+/**
+ * pqWheelRedistribute: Moves a chain of nodes, linked through node->next, to their slots in the order of the chain.
+ * Nodes of equal priority are always in the same slot, so they keep their order
+ * @param wheel
+ * @param node - the first node of the chain
+ */
+static void pqWheelRedistribute(pqWheel wheel, pqNode node) {
+    while (node != NULL) {
+        pqNode next = node->next;
+        pqWheelAppend(wheel, node, pqWheelSlot(wheel, pqWheelKey(node)));
+        node = next;
+    }
+}
+
+/**
+ * pqWheelRebuild: Places all the nodes in new slots, around a new time below all of them
+ * @param wheel
+ * @param now
+ */
+static void pqWheelRebuild(pqWheel wheel, uint64_t now) {
+    pqNode chain = NULL, chain_last = NULL;
+    for (int slot = pqWheelFirstSlotFrom(wheel, 0); slot != NO_SLOT; slot = pqWheelFirstSlotFrom(wheel, slot + 1)) {
+        pqNode slot_last = wheel->last[slot];
+        if (chain_last == NULL) {
+            chain = pqWheelTake(wheel, slot);
+        } else {
+            chain_last->next = pqWheelTake(wheel, slot);
+        }
+        chain_last = slot_last;
+    }
+    wheel->now = now;
+    pqWheelRedistribute(wheel, chain);
+}
+
+
+/*
+ * FUNCTIONS FOR pqWheel
+ */
+
+pqWheel pqWheelCreate(void) {
+    pqWheel wheel = malloc(sizeof(*wheel));
+    if (wheel == NULL) {
+        return NULL;
+    }
+    for (int slot = 0; slot < WHEEL_LEVELS * WHEEL_SLOTS; slot++) {
+        wheel->first[slot] = NULL;
+        wheel->last[slot] = NULL;
+    }
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        wheel->occupied[level] = 0;
+        wheel->sorted[level] = 0;
+    }
+    wheel->now = 0;
+    wheel->size = 0;
+    wheel->rebuilds = 0;
+    return wheel;
+}
+
+void pqWheelDestroy(pqWheel wheel) {
+    free(wheel);
+}
+
+void pqWheelPush(pqWheel wheel, pqNode node) {
+    uint64_t key = pqWheelKey(node);
+    if (wheel->size == 0) {
+        wheel->now = key;
+    } else if (key < wheel->now) {
+        pqWheelRebuild(wheel, key);
+        wheel->rebuilds = wheel->rebuilds + 1;
+    }
+    pqWheelAppend(wheel, node, pqWheelSlot(wheel, key));
+    wheel->size = wheel->size + 1;
+}
+
+pqNode pqWheelTop(pqWheel wheel) {
+    if (wheel == NULL || wheel->size == 0) {
+        return NULL;
+    }
+    int slot = pqWheelFirstSlotFrom(wheel, 0);
+    if (slot >= WHEEL_SLOTS) {
+        uint64_t now = pqWheelKey(wheel->first[slot]);
+        for (pqNode node = wheel->first[slot]; node != NULL; node = node->next) {
+            if (pqWheelKey(node) < now) {
+                now = pqWheelKey(node);
+            }
+        }
+        pqNode chain = pqWheelTake(wheel, slot);
+        wheel->now = now;
+        pqWheelRedistribute(wheel, chain);
+        slot = pqWheelFirstSlotFrom(wheel, 0);
+    }
+    pqWheelSortSlot(wheel, slot);
+    return wheel->first[slot];
+}
+
+int pqWheelTopK(pqWheel wheel, int k, pqNode *out) {
+    pqWheelTop(wheel);
+    int count = 0;
+    for (pqNode node = pqWheelOrderedFirst(wheel); node != NULL && count < k; node = pqWheelOrderedNext(wheel, node)) {
+        out[count] = node;
+        count = count + 1;
+    }
+    return count;
+}
+
+void pqWheelRemove(pqWheel wheel, pqNode node) {
+    pqWheelUnlink(wheel, node);
+    node->next = NULL;
+    node->prev = NULL;
+    node->index = NODE_NOT_IN_HEAP;
+    wheel->size = wheel->size - 1;
+}
+
+void pqWheelUpdate(pqWheel wheel, pqNode node) {
+    pqWheelRemove(wheel, node);
+    pqWheelPush(wheel, node);
+}
+
+pqNode pqWheelOrderedFirst(pqWheel wheel) {
+    int slot = pqWheelFirstSlotFrom(wheel, 0);
+    if (slot == NO_SLOT) {
+        return NULL;
+    }
+    pqWheelSortSlot(wheel, slot);
+    return wheel->first[slot];
+}
+
+pqNode pqWheelOrderedNext(pqWheel wheel, pqNode node) {
+    if (node->next != NULL) {
+        return node->next;
+    }
+    int slot = pqWheelFirstSlotFrom(wheel, node->index + 1);
+    if (slot == NO_SLOT) {
+        return NULL;
+    }
+    pqWheelSortSlot(wheel, slot);
+    return wheel->first[slot];
+}
+
+pqNode pqWheelFirst(pqWheel wheel) {
+    int slot = pqWheelFirstSlotFrom(wheel, 0);
+    return slot == NO_SLOT ? NULL : wheel->first[slot];
+}
+
+pqNode pqWheelNext(pqWheel wheel, pqNode node) {
+    if (node->next != NULL) {
+        return node->next;
+    }
+    int slot = pqWheelFirstSlotFrom(wheel, node->index + 1);
+    return slot == NO_SLOT ? NULL : wheel->first[slot];
+}
+
+int pqWheelGetSize(pqWheel wheel) {
+    if (wheel == NULL) {
+        return 0;
+    }
+    return wheel->size;
+}
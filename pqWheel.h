@@ -0,0 +1,158 @@
+#ifndef EX1_PQWHEEL_H
+#define EX1_PQWHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "priority_queue.h"
+#include "pqNode.h"
+
+typedef struct pqWheel_t *pqWheel;
+
+/** Every level of the wheel has a slot for each of the 64 values of a 6 bit digit of the priority */
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS 64
+/** Enough levels for all the 64 bits of a priority, the last level only uses 16 of its slots */
+#define WHEEL_LEVELS 11
+
+
+/*
+ * STRUCTS
+ */
+
+/**
+ * Struct representing a hierarchical timing wheel of the nodes of a scalar queue. Level l of the wheel holds the
+ * nodes whose priority first differs from now, the last priority taken from the top, in digit l, and its slots are
+ * the values of that digit. Level 0 holds the nodes that are due soonest, one priority per slot, and every level
+ * above it covers 64 times the range of the one below, so priorities far away don't need more slots.
+ * The nodes of every slot are linked through node->next and node->prev in the order they were added, and node->index
+ * is the node's slot, counted over all the levels. occupied has a bit set for every slot that isn't empty, so the
+ * first slot of a level is found without going over the empty ones. sorted has a bit set for every slot whose nodes
+ * are linked in the order of the queue: a slot is sorted in place the first time it is walked in order, and stays
+ * sorted until a node is added out of order. Like the heap, the wheel does not own the nodes it holds.
+ * A priority below now can't be placed in a slot, so the whole wheel is rebuilt around it, rebuilds counts these
+ * rebuilds
+ */
+struct pqWheel_t {
+    pqNode first[WHEEL_LEVELS * WHEEL_SLOTS];
+    pqNode last[WHEEL_LEVELS * WHEEL_SLOTS];
+    uint64_t occupied[WHEEL_LEVELS];
+    uint64_t sorted[WHEEL_LEVELS];
+    uint64_t now;
+    int size;
+    unsigned long rebuilds;
+};
+
+/**
+ * pqWheelCreate: Creates a new empty wheel
+ * @return
+ *      NULL if memory allocation failed
+ *      the new wheel if it didn't
+ */
+pqWheel pqWheelCreate(void);
+
+/**
+ * pqWheelDestroy: Frees the wheel itself, the nodes inside it are not freed
+ * @param wheel
+ */
+void pqWheelDestroy(pqWheel wheel);
+
+/**
+ * pqWheelPush: Adds a node to the wheel in O(1). A node whose priority is below the last priority taken from the top
+ * rebuilds the wheel in O(n) instead
+ * @param wheel
+ * @param node
+ */
+void pqWheelPush(pqWheel wheel, pqNode node);
+
+/**
+ * pqWheelTop: Retrieve the highest priority node of the wheel, ties are broken by the node's sequence. When level 0
+ * is empty, the time advances to the first slot of the lowest level that isn't, and only the nodes of that slot are
+ * moved down to the levels below it. A node moves down at most once per level, so this is O(1) amortized while
+ * priorities don't go backwards
+ * @param wheel
+ * @return
+ *      NULL if the wheel is empty
+ *      the top node otherwise
+ */
+pqNode pqWheelTop(pqWheel wheel);
+
+/**
+ * pqWheelTopK: Retrieve the k highest priority nodes of the wheel in order, without removing them. The time advances
+ * to the first node as in pqWheelTop, so looking at the first node alone is O(1) amortized. The slots are then walked
+ * in order as by pqWheelOrderedFirst
+ * @param wheel
+ * @param k
+ * @param out - an array of at least k nodes that receives the nodes
+ * @return
+ *      the amount of nodes written to out, k or the size of the wheel if it is smaller
+ */
+int pqWheelTopK(pqWheel wheel, int k, pqNode *out);
+
+/**
+ * pqWheelRemove: Removes a node from the wheel in O(1)
+ * @param wheel
+ * @param node
+ */
+void pqWheelRemove(pqWheel wheel, pqNode node);
+
+/**
+ * pqWheelUpdate: Moves a node to its right place after its priority or sequence has changed, in O(1) unless its new
+ * priority is below the last priority taken from the top
+ * @param wheel
+ * @param node
+ */
+void pqWheelUpdate(pqWheel wheel, pqNode node);
+
+/**
+ * pqWheelOrderedFirst: Retrieve the first node of the wheel in the order of the queue, for walking all the nodes in
+ * that order with pqWheelOrderedNext. The slots are taken level by level, and each slot is sorted in place when the
+ * walk enters it, in O(m log m) for the m nodes added to it out of order since it was last sorted, and O(m) for the
+ * others. A walk of a wheel that didn't change since the last one sorts nothing and allocates nothing
+ * @param wheel
+ * @return
+ *      NULL if the wheel is empty
+ *      the first node otherwise
+ */
+pqNode pqWheelOrderedFirst(pqWheel wheel);
+
+/**
+ * pqWheelOrderedNext: Retrieve the node after node in the order of the queue, node must have been reached by
+ * pqWheelOrderedFirst and pqWheelOrderedNext with no change to the wheel since
+ * @param wheel
+ * @param node
+ * @return
+ *      NULL if node is the last node
+ *      the next node otherwise
+ */
+pqNode pqWheelOrderedNext(pqWheel wheel, pqNode node);
+
+/**
+ * pqWheelFirst: Retrieve the first node of the wheel in the order of its slots, for walking all the nodes with
+ * pqWheelNext without changing the wheel. This is not the order of the queue
+ * @param wheel
+ * @return
+ *      NULL if the wheel is empty
+ *      the first node otherwise
+ */
+pqNode pqWheelFirst(pqWheel wheel);
+
+/**
+ * pqWheelNext: Retrieve the node after node in the order of the slots
+ * @param wheel
+ * @param node
+ * @return
+ *      NULL if node is the last node
+ *      the next node otherwise
+ */
+pqNode pqWheelNext(pqWheel wheel, pqNode node);
+
+/**
+ * pqWheelGetSize: Retrieve the amount of nodes in the wheel
+ * @param wheel
+ * @return
+ *      the amount of nodes in the wheel
+ */
+int pqWheelGetSize(pqWheel wheel);
+
+
+#endif //EX1_PQWHEEL_H
@@ -4,43 +4,183 @@
  * priority to lowest priority
 **/
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
 #include "priority_queue.h"
 #include "pqNode.h"
+#include "pqHeap.h"
+#include "pqArray.h"
+#include "pqIndex.h"
+#include "pqBuffer.h"
+#include "pqRadix.h"
+#include "pqWheel.h"
+#include "pqStats.h"
 
 #define ELEMENT_NOT_FOUND -1
+#define RELAXED_POP_ATTEMPTS 4
+
+/** The most strictly aligned types, the slots of a bounded queue are aligned for all of them */
+typedef union {
+    long double long_double;
+    long long long_long;
+    void *pointer;
+} pqSlotAlignment;
+
+static pthread_key_t random_state_key;
+static pthread_once_t random_state_once = PTHREAD_ONCE_INIT;
+
+#ifdef PQ_STATS
+__thread PQCounters *pq_counters = NULL;
+#endif
 
 /*
  * STRUCTS
  */
 
 /**
- * Struct representing the queue, with the first and last nodes linked, size in integer, iterator for users,
- * and all functions that the user supplies
+ * Struct representing an iterator over a queue. With PQ_BACKEND_LIST and PQ_BACKEND_WHEEL it follows the nodes from
+ * current, with the other backends it walks order, a sorted snapshot of the count nodes taken when the iteration
+ * started.
+ * version is the queue's version when the iteration started.
+ */
+struct PQIterator_t {
+    PriorityQueue queue;
+    pqNode current;
+    pqNode *order;
+    int count;
+    int position;
+    unsigned long version;
+};
+
+/**
+ * Struct representing the entries of a queue, with the first and last nodes linked and size in integer. All the nodes
+ * are taken from pool. With PQ_BACKEND_HEAP the nodes are kept in heap instead of being linked from first, with
+ * PQ_BACKEND_ARRAY in array, with PQ_BACKEND_RADIX in radix and with PQ_BACKEND_WHEEL in wheel.
+ * A queue created by pqCreateIndexed also keeps every node in index, so finding an element doesn't scan the queue.
+ * dead counts the tombstones among the size nodes, which are not in index, see pqSetLazyDeletion.
+ * version counts the modifications of the entries, so iterators can tell they were invalidated.
+ * pqCopy doesn't copy the entries, it shares them between refs queues until one of them is modified, see pqDetach.
+ * owner is the queue whose handles point to these nodes, if it is still sharing them.
+ * The entries of a bounded queue keep the values of all of their nodes in storage, see pqNodeSlot.
+ */
+struct pqEntries_t {
+    int refs;
+    PriorityQueue owner;
+    int size;
+    int dead;
+    pqNode first;
+    pqNode last;
+    pqNodePool pool;
+    pqHeap heap;
+    pqArray array;
+    pqRadix radix;
+    pqWheel wheel;
+    pqIndex index;
+    unsigned long next_sequence;
+    unsigned long version;
+    char *storage;
+};
+
+typedef struct pqEntries_t *pqEntries;
+
+/**
+ * Struct representing the queue, with its entries, iterator for users, and all functions that the user supplies.
+ * A scalar queue has no priority functions, its priorities are kept inside the nodes.
+ * trivialDestruction is set by pqSetTrivialDestruction.
+ * A queue created by pqCreateConcurrent is concurrent, and every function takes its lock for reading or writing.
+ * A concurrent queue with PQ_BACKEND_HEAP has fine-grained locking instead: its inserts and pops take the lock for
+ * reading and then the locks of the positions of the heap they move nodes through, while the functions that read
+ * the nodes take it for writing, see pqLockShared. nodes_lock guards the pool of its nodes and its iterator meanwhile.
+ * A queue created by pqCreateRelaxed keeps no entries of its own, they are spread between its sub_queue_count
+ * concurrent sub_queues.
+ * A queue created by pqCreateBuffered has a positive buffer_size. Each thread inserts into a buffer of its own, kept
+ * under buffer_key and linked from buffers under buffers_lock. flushes and flushed count the flushes of the buffers.
+ * The locks are always taken in the order buffers_lock, the lock of a buffer, and then the lock of the queue.
+ * A queue created by pqCreateBounded has a positive capacity, and keeps its elements and priorities by value in the
+ * storage of its entries, in slots of slot_size bytes with the priority at priority_offset.
+ * A queue in lazy deletion mode has a positive compaction_fraction, and compactions counts its compactions, which took
+ * compaction_seconds in total.
+ * A library compiled with PQ_STATS keeps the counters of every queue, see pqStats.h.
  */
 struct PriorityQueue_t {
+    PQBackend backend;
     CopyPQElement copyElement;
     FreePQElement freeElement;
     EqualPQElements equalElements;
     CopyPQElementPriority copyPriority;
     FreePQElementPriority freePriority;
     ComparePQElementPriorities comparePriorities;
-    int iterator;
-    pqNode iteratorP;
-    int size;
-    pqNode first;
+    HashPQElement hashElement;
+    bool trivialDestruction;
+    bool concurrent;
+    pthread_rwlock_t lock;
+    pthread_mutex_t nodes_lock;
+    PriorityQueue *sub_queues;
+    int sub_queue_count;
+    PQFlushPolicy flush_policy;
+    int buffer_size;
+    pthread_key_t buffer_key;
+    pthread_mutex_t buffers_lock;
+    pqBuffer buffers;
+    unsigned long flushes;
+    unsigned long flushed;
+    int capacity;
+    size_t element_size;
+    size_t priority_size;
+    size_t priority_offset;
+    size_t slot_size;
+    double compaction_fraction;
+    unsigned long compactions;
+    double compaction_seconds;
+#ifdef PQ_STATS
+    PQCounters counters;
+#endif
+    struct PQIterator_t iterator;
+    pqEntries entries;
 };
 
 /*
  * STATIC FUNCTIONS FOR PriorityQueue
  */
+/**
+ * pqStatsNoteSize: Raises the max_size counter of a queue to its current size, called after the queue grew. The size
+ * and the counter are read and raised atomically, since the inserts of a queue with fine-grained locking run at once
+ * @param queue
+ */
+inline static void pqStatsNoteSize(PriorityQueue queue) {
+#ifdef PQ_STATS
+    unsigned long size = (unsigned long) (__atomic_load_n(&queue->entries->size, __ATOMIC_RELAXED) -
+                                          queue->entries->dead);
+    unsigned long max_size = __atomic_load_n(&queue->counters.max_size, __ATOMIC_RELAXED);
+    while (size > max_size && __atomic_compare_exchange_n(&queue->counters.max_size, &max_size, size, false,
+                                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false) {
+    }
+#endif
+}
+
+/**
+ * pqStatsReset: Zeroes the counters of a queue, its max_size starting again from its current size
+ * @param queue
+ */
+inline static void pqStatsReset(PriorityQueue queue) {
+#ifdef PQ_STATS
+    memset(&queue->counters, 0, sizeof(queue->counters));
+    pqStatsNoteSize(queue);
+#endif
+}
+
 inline static PriorityQueueResult pqUpdateSizeAfterInsertAndReturnSuccess(PriorityQueue queue) {
     if (queue == NULL) {
         return PQ_OUT_OF_MEMORY;
     }
-    queue->size = queue->size + 1;
+    queue->entries->size = queue->entries->size + 1;
+    pqStatsNoteSize(queue);
     return PQ_SUCCESS;
 }
 
@@ -48,19 +188,153 @@ inline static PriorityQueueResult pqUpdateSizeAfterRemoveAndReturnSuccess(Priori
     if (queue == NULL) {
         return PQ_OUT_OF_MEMORY;
     }
-    queue->size = queue->size - 1;
+    queue->entries->size = queue->entries->size - 1;
     return PQ_SUCCESS;
 }
 
 /**
- * isPQEmpty: whether the queue is empty
+ * isPQEmpty: whether the queue is empty, tombstones aside
  * @param queue - the queue the function checks
  * @return
- *      TRUE if the queue is empty according to pqGetSize
+ *      TRUE if the queue is empty
  *      FALSE is the queue is not empty
  */
 inline static bool isPQEmpty(PriorityQueue queue) {
-    return (pqGetSize(queue) == 0);
+    return (queue->entries->size == queue->entries->dead);
+}
+
+/**
+ * pqStatsAdd: Adds the counters of a queue to a sum of counters, for pqGetStats. The counters are read atomically,
+ * since the other threads reading a concurrent queue may be adding to them
+ * @param sum
+ * @param queue
+ */
+static void pqStatsAdd(PQCounters *sum, PriorityQueue queue) {
+#ifdef PQ_STATS
+    PQCounters *counters = &queue->counters;
+    sum->comparisons = sum->comparisons + __atomic_load_n(&counters->comparisons, __ATOMIC_RELAXED);
+    sum->copy_calls = sum->copy_calls + __atomic_load_n(&counters->copy_calls, __ATOMIC_RELAXED);
+    sum->free_calls = sum->free_calls + __atomic_load_n(&counters->free_calls, __ATOMIC_RELAXED);
+    sum->equal_calls = sum->equal_calls + __atomic_load_n(&counters->equal_calls, __ATOMIC_RELAXED);
+    sum->compare_calls = sum->compare_calls + __atomic_load_n(&counters->compare_calls, __ATOMIC_RELAXED);
+    sum->hash_calls = sum->hash_calls + __atomic_load_n(&counters->hash_calls, __ATOMIC_RELAXED);
+    sum->inserts = sum->inserts + __atomic_load_n(&counters->inserts, __ATOMIC_RELAXED);
+    sum->insert_traversals = sum->insert_traversals + __atomic_load_n(&counters->insert_traversals, __ATOMIC_RELAXED);
+    sum->lookups = sum->lookups + __atomic_load_n(&counters->lookups, __ATOMIC_RELAXED);
+    sum->lookup_traversals = sum->lookup_traversals + __atomic_load_n(&counters->lookup_traversals, __ATOMIC_RELAXED);
+    sum->allocations = sum->allocations + __atomic_load_n(&counters->allocations, __ATOMIC_RELAXED);
+    sum->allocated_bytes = sum->allocated_bytes + __atomic_load_n(&counters->allocated_bytes, __ATOMIC_RELAXED);
+    sum->max_size = sum->max_size + counters->max_size;
+#endif
+}
+
+/**
+ * pqStatsBegin: Makes the work of the calling thread count for a queue, unless it already counts for another queue,
+ * the one whose function called this queue's
+ * @param queue
+ */
+inline static void pqStatsBegin(PriorityQueue queue) {
+#ifdef PQ_STATS
+    if (pq_counters == NULL) {
+        pq_counters = &queue->counters;
+    }
+#endif
+}
+
+/**
+ * pqStatsEnd: Stops counting the work of the calling thread for a queue, if pqStatsBegin started it
+ * @param queue
+ */
+inline static void pqStatsEnd(PriorityQueue queue) {
+#ifdef PQ_STATS
+    if (pq_counters == &queue->counters) {
+        pq_counters = NULL;
+    }
+#endif
+}
+
+/**
+ * pqFineGrained: Checks whether a queue has fine-grained locking, which every concurrent queue with PQ_BACKEND_HEAP
+ * has
+ * @param queue
+ * @return
+ *      true if it does
+ *      false otherwise
+ */
+inline static bool pqFineGrained(PriorityQueue queue) {
+    return queue->concurrent && queue->backend == PQ_BACKEND_HEAP;
+}
+
+/**
+ * pqSharedPathOpen: Checks whether the inserts and pops of a queue with fine-grained locking can run under its shared
+ * lock. A queue in lazy deletion mode is modified under the lock for writing, as its tombstones are compacted
+ * @param queue
+ * @return
+ *      true if they can
+ *      false otherwise
+ */
+inline static bool pqSharedPathOpen(PriorityQueue queue) {
+    return queue->compaction_fraction == 0 && pqHeapIsConcurrent(queue->entries->heap);
+}
+
+/**
+ * pqLockWrite: Takes the lock of a concurrent queue for writing, no other thread can use the queue meanwhile
+ * @param queue
+ */
+inline static void pqLockWrite(PriorityQueue queue) {
+    pqStatsBegin(queue);
+    if (queue->concurrent) {
+        pthread_rwlock_wrlock(&queue->lock);
+    }
+}
+
+/**
+ * pqLockShared: Takes the lock of a concurrent queue for reading, other threads can take it the same way at the same
+ * time. A queue with fine-grained locking is modified under this lock by pqInsertShared and pqPopShared
+ * @param queue
+ */
+inline static void pqLockShared(PriorityQueue queue) {
+    pqStatsBegin(queue);
+    if (queue->concurrent) {
+        pthread_rwlock_rdlock(&queue->lock);
+    }
+}
+
+/**
+ * pqLockRead: Takes the lock of a concurrent queue for reading its nodes, other threads can read the queue at the
+ * same time. The nodes of a queue with fine-grained locking move under its shared lock, so it takes it for writing
+ * @param queue
+ */
+inline static void pqLockRead(PriorityQueue queue) {
+    if (pqFineGrained(queue)) {
+        pqLockWrite(queue);
+    } else {
+        pqLockShared(queue);
+    }
+}
+
+/**
+ * pqLockWalk: Takes the lock of a concurrent queue for walking it in order without changing its elements. Walking a
+ * PQ_BACKEND_WHEEL queue sorts the slots it enters, so it takes the lock for writing, the other backends for reading
+ * @param queue
+ */
+inline static void pqLockWalk(PriorityQueue queue) {
+    if (queue->backend == PQ_BACKEND_WHEEL) {
+        pqLockWrite(queue);
+    } else {
+        pqLockRead(queue);
+    }
+}
+
+/**
+ * pqUnlock: Releases the lock of a concurrent queue
+ * @param queue
+ */
+inline static void pqUnlock(PriorityQueue queue) {
+    if (queue->concurrent) {
+        pthread_rwlock_unlock(&queue->lock);
+    }
+    pqStatsEnd(queue);
 }
 
 /**
@@ -72,14 +346,16 @@ inline static bool isPQEmpty(PriorityQueue queue) {
  * @param node
  * @return
  *      TRUE if the node has the element and priority/only element if priority is NULL
- *      FALSE if not or if NULL was sent as parameter in node or element
+ *      FALSE if not, if node is a tombstone or if NULL was sent as parameter in node or element
  */
 static bool pqNodeSame(PriorityQueue queue, PQElement element, PQElementPriority priority, pqNode node) {
-    if (element == NULL || node == NULL) {
+    PQ_COUNT(lookup_traversals, 1);
+    if (element == NULL || node == NULL || node->dead) {
         return false;
     }
+    PQ_COUNT(equal_calls, 1);
     if (queue->equalElements(element, pqNodeGetElement(node))) {
-        if (priority == NULL || queue->comparePriorities(priority, pqNodeGetPriority(node)) == 0) {
+        if (priority == NULL || pqNodeHasPriority(node, priority, queue->comparePriorities)) {
             return true;
         }
     }
@@ -87,305 +363,2925 @@ static bool pqNodeSame(PriorityQueue queue, PQElement element, PQElementPriority
 }
 
 /**
- * pqContainsWithPriority: Checks if a certain element with a certain priority (can be set to NULL as to ignore
- * priority) exist in queue
- * @param queue
- * @param element
- * @param priority
- * @return
+ * pqIteratorReset: Sets an iterator to NULL and frees its snapshot
+ * @param iterator
  */
-static bool pqContainsWithPriority(PriorityQueue queue, PQElement element, PQElementPriority priority) {
-    if (queue == NULL || element == NULL) {
-        return NULL;
-    }
-    pqNode temp = queue->first;
-    int size = queue->size;
-    while (size != 0) {
-        if (pqNodeSame(queue, element, priority, temp) == false) {
-            if (temp->next != NULL) {
-                temp = (pqNode) temp->next;
-                size = size - 1;
-            } else {
-                break;
-            }
-        } else {
-            return true;
-        }
-    }
-    return false;
+static void pqIteratorReset(PQIterator iterator) {
+    iterator->current = NULL;
+    free(iterator->order);
+    iterator->order = NULL;
+    iterator->count = 0;
+    iterator->position = ELEMENT_NOT_FOUND;
+}
 
+/**
+ * pqIteratorInit: Initializes an iterator over queue that isn't pointing at any element yet
+ * @param iterator
+ * @param queue
+ */
+static void pqIteratorInit(PQIterator iterator, PriorityQueue queue) {
+    iterator->queue = queue;
+    iterator->order = NULL;
+    pqIteratorReset(iterator);
+    iterator->version = queue->entries->version;
 }
 
 /**
- * setIteratorToNULL: sets the queue's iterator to NULL
+ * setIteratorToNULL: sets the queue's iterator to NULL, and invalidates all the other iterators of the queue, as
+ * it is called whenever the queue is modified
  * @param queue
  */
 inline static void setIteratorToNULL(PriorityQueue queue) {
     if (queue == NULL) {
         return;
     }
-    queue->iterator = ELEMENT_NOT_FOUND;
-    queue->iteratorP = NULL;
+    pqIteratorReset(&queue->iterator);
+    queue->entries->version = queue->entries->version + 1;
 }
 
 /**
- * pqRemoveElementAndPriority: Removes a certain element with a certain priority (can be set to NULL as to be ignored)
+ * pqHeapFindNode: Finds the highest priority node in the heap that has a certain element with a certain priority
+ * (can be set to NULL as to ignore priority)
  * @param queue
  * @param element
  * @param priority
  * @return
+ *      NULL if no such node exists
+ *      the node otherwise
  */
-static PriorityQueueResult pqRemoveElementAndPriority(PriorityQueue queue, PQElement element,
-                                                      PQElementPriority priority) {
-    if (queue == NULL || element == NULL) {
-        return PQ_NULL_ARGUMENT;
-    }
-    pqNode before = queue->first;
-    if (queue->equalElements(element, pqNodeGetElement(before))) {
-        if (priority == NULL || queue->comparePriorities(priority, pqNodeGetPriority(before)) == 0) {
-            pqNode temp = before->next;
-            queue->first = temp;
-            pqNodeFree(before);
-            return pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
-        }
-    }
-    while (before->next != NULL) {
-        if (queue->equalElements(element, pqNodeGetElement(before->next))) {
-            if (priority == NULL || queue->comparePriorities(priority, pqNodeGetPriority(before->next)) == 0) {
-                pqNode temp = before->next;
-                before->next = temp->next;
-                pqNodeFree(temp);
-                return pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
-            }
+static pqNode pqHeapFindNode(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    pqNode found = NULL;
+    int size = pqHeapGetSize(queue->entries->heap);
+    for (int i = 0; i < size; i++) {
+        pqNode node = pqHeapGet(queue->entries->heap, i);
+        if (pqNodeSame(queue, element, priority, node) &&
+            (found == NULL || pqNodeCompare(node, found, queue->comparePriorities) > 0)) {
+            found = node;
         }
-        before = before->next;
     }
-    if (queue->size == 1) {
-        pqNodeFree(before);
-        queue->first = NULL;
-        return pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
-    }
-    return PQ_ERROR;
+    return found;
 }
 
-
-/*
- * PROVIDED FUNCTIONS FOR PriorityQueue
+/**
+ * pqNodeSlot: Retrieve the slot of a node of a bounded queue in the storage of its entries. All the nodes of the
+ * entries come from the single chunk their pool reserved, so the node's position in it is the position of its slot
+ * @param queue
+ * @param entries - the entries the node belongs to
+ * @param node
+ * @return
+ *      the slot of the node, holding its element followed by its priority
  */
+inline static char *pqNodeSlot(PriorityQueue queue, pqEntries entries, pqNode node) {
+    return entries->storage + (size_t) (node - entries->pool->chunks->nodes) * queue->slot_size;
+}
 
-PriorityQueue pqCreate(CopyPQElement copy_element,
-                       FreePQElement free_element,
-                       EqualPQElements equal_elements,
-                       CopyPQElementPriority copy_priority,
-                       FreePQElementPriority free_priority,
-                       ComparePQElementPriorities compare_priorities) {
-    if (copy_element == NULL || free_element == NULL || equal_elements == NULL ||
-        copy_priority == NULL || free_priority == NULL || compare_priorities == NULL) {
-        return NULL;
-    }
-    PriorityQueue queue = malloc(sizeof(*queue));
-    if (queue == NULL) {
-        return NULL;
+/**
+ * pqArrayFindNode: Finds the highest priority node in the array that has a certain element with a certain priority
+ * (can be set to NULL as to ignore priority). The array is walked in order, from the first node holding priority if
+ * there is one
+ * @param queue
+ * @param element
+ * @param priority
+ * @return
+ *      NULL if no such node exists
+ *      the node otherwise
+ */
+static pqNode pqArrayFindNode(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    pqArray array = queue->entries->array;
+    int size = pqArrayGetSize(array);
+    int i = priority == NULL ? 0 : pqArrayFind(array, *(PQScalarPriority *) priority);
+    for (; i < size; i++) {
+        pqNode node = pqArrayGet(array, i);
+        if (priority != NULL && node->priority.scalar != *(PQScalarPriority *) priority) {
+            return NULL;
+        }
+        if (pqNodeSame(queue, element, priority, node)) {
+            return node;
+        }
     }
-    queue->copyElement = copy_element;
-    queue->freeElement = free_element;
-    queue->equalElements = equal_elements;
-    queue->copyPriority = copy_priority;
-    queue->freePriority = free_priority;
-    queue->comparePriorities = compare_priorities;
-    queue->iterator = ELEMENT_NOT_FOUND;
-    queue->iteratorP = NULL;
-    queue->size = 0;
-    queue->first = NULL;
-    return queue;
+    return NULL;
 }
 
-void pqDestroy(PriorityQueue queue) {
-    if (queue == NULL) {
-        return;
-    }
-    while (pqGetSize(queue) != 0) {
-        pqRemove(queue);
-    }
-    free(queue);
+/**
+ * pqUsesBuckets: Checks whether a queue keeps its nodes in buckets, with PQ_BACKEND_RADIX or PQ_BACKEND_WHEEL
+ * @param queue
+ * @return
+ *      true if it does
+ *      false otherwise
+ */
+inline static bool pqUsesBuckets(PriorityQueue queue) {
+    return queue->backend == PQ_BACKEND_RADIX || queue->backend == PQ_BACKEND_WHEEL;
 }
 
-PriorityQueue pqCopy(PriorityQueue queue) {
-    if (queue == NULL) {
-        return NULL;
-    }
-    PriorityQueue new_queue = pqCreate(queue->copyElement,
-                                       queue->freeElement,
-                                       queue->equalElements,
-                                       queue->copyPriority,
-                                       queue->freePriority,
-                                       queue->comparePriorities);
-    if (new_queue == NULL) {
-        return NULL;
-    }
-    int size = queue->size;
-    new_queue->size = size;
-    if (size > 0) {
-        pqNode copy = pqNodeCopyFull(queue->first);
-        new_queue->first = copy;
-        size = size - 1;
+/**
+ * pqBucketsFirst: Retrieve the first node in the buckets of entries, for walking all of their nodes with
+ * pqBucketsNext. This is not the order of the queue
+ * @param queue - the queue the entries belong to
+ * @param entries
+ * @return
+ *      NULL if there are no nodes
+ *      the first node otherwise
+ */
+static pqNode pqBucketsFirst(PriorityQueue queue, pqEntries entries) {
+    return queue->backend == PQ_BACKEND_RADIX ? pqRadixFirst(entries->radix) : pqWheelFirst(entries->wheel);
+}
+
+/**
+ * pqBucketsNext: Retrieve the node after node in the buckets of entries
+ * @param queue - the queue the entries belong to
+ * @param entries
+ * @param node
+ * @return
+ *      NULL if node is the last node
+ *      the next node otherwise
+ */
+static pqNode pqBucketsNext(PriorityQueue queue, pqEntries entries, pqNode node) {
+    return queue->backend == PQ_BACKEND_RADIX ? pqRadixNext(entries->radix, node) : pqWheelNext(entries->wheel, node);
+}
+
+/**
+ * pqBucketsPush: Adds a node to the buckets of entries
+ * @param queue - the queue the entries belong to
+ * @param entries
+ * @param node
+ */
+static void pqBucketsPush(PriorityQueue queue, pqEntries entries, pqNode node) {
+    if (queue->backend == PQ_BACKEND_RADIX) {
+        pqRadixPush(entries->radix, node);
+    } else {
+        pqWheelPush(entries->wheel, node);
     }
-    setIteratorToNULL(new_queue);
-    setIteratorToNULL(queue);
-    return new_queue;
 }
 
-int pqGetSize(PriorityQueue queue) {
-    if (queue == NULL) {
-        return ELEMENT_NOT_FOUND;
+/**
+ * pqBucketsFindNode: Finds the highest priority node in the buckets of the queue that has a certain element with a
+ * certain priority (can be set to NULL as to ignore priority)
+ * @param queue
+ * @param element
+ * @param priority
+ * @return
+ *      NULL if no such node exists
+ *      the node otherwise
+ */
+static pqNode pqBucketsFindNode(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    pqNode found = NULL;
+    pqEntries entries = queue->entries;
+    for (pqNode node = pqBucketsFirst(queue, entries); node != NULL; node = pqBucketsNext(queue, entries, node)) {
+        if (pqNodeSame(queue, element, priority, node) &&
+            (found == NULL || pqNodeCompare(node, found, queue->comparePriorities) > 0)) {
+            found = node;
+        }
     }
-    return queue->size;
+    return found;
 }
 
-bool pqContains(PriorityQueue queue, PQElement element) {
-    if (queue == NULL || element == NULL) {
-        return NULL;
+/**
+ * pqNodeSetElement: Stores a copy of an element given by the user in a new node of the queue's entries. The copy of
+ * a bounded queue is a copy of the element's bytes in the node's slot
+ * @param queue
+ * @param node
+ * @param element
+ * @return
+ *      false if copying the element failed
+ *      true otherwise
+ */
+static bool pqNodeSetElement(PriorityQueue queue, pqNode node, PQElement element) {
+    if (queue->capacity > 0) {
+        node->element = memcpy(pqNodeSlot(queue, queue->entries, node), element, queue->element_size);
+        return true;
     }
-    return pqContainsWithPriority(queue, element, NULL);
+    PQ_COUNT(copy_calls, 1);
+    node->element = queue->copyElement(element);
+    return node->element != NULL;
 }
 
-PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority) {
-    if (queue == NULL || element == NULL || priority == NULL) {
-        return PQ_NULL_ARGUMENT;
+/**
+ * pqNodeSetPriority: Stores a priority given by the user in a node of the queue's entries: a copy of it, replacing
+ * the node's previous priority, its value in a scalar queue, or a copy of its bytes in the node's slot in a bounded
+ * queue
+ * @param queue
+ * @param node
+ * @param priority
+ * @return
+ *      false if copying the priority failed, the node is unchanged in that case
+ *      true otherwise
+ */
+static bool pqNodeSetPriority(PriorityQueue queue, pqNode node, PQElementPriority priority) {
+    if (queue->comparePriorities == NULL) {
+        node->priority.scalar = *(PQScalarPriority *) priority;
+        return true;
     }
-    pqNode new_node = pqNodeCreate(queue->copyElement(element), queue->copyPriority(priority), NULL,
-                                   queue->copyElement, queue->freeElement, queue->copyPriority, queue->freePriority);
-    setIteratorToNULL(queue);
-    if (new_node == NULL || new_node->element == NULL || new_node->priority == NULL) {
-        return PQ_OUT_OF_MEMORY;
+    if (queue->capacity > 0) {
+        char *slot = pqNodeSlot(queue, queue->entries, node);
+        node->priority.pointer = memmove(slot + queue->priority_offset, priority, queue->priority_size);
+        return true;
     }
-    if (queue->first == NULL) {
-        queue->first = new_node;
-        return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    PQ_COUNT(copy_calls, 1);
+    PQElementPriority priority_copy = queue->copyPriority(priority);
+    if (priority_copy == NULL) {
+        return false;
     }
-    int priority_new_node_first_in_queue = queue->comparePriorities(new_node->priority, queue->first->priority);
-    if (priority_new_node_first_in_queue > 0) {
-        new_node->next = queue->first;
-        queue->first = new_node;
-        return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    if (node->priority.pointer != NULL) {
+        PQ_COUNT(free_calls, 1);
+        queue->freePriority(node->priority.pointer);
     }
-    if (priority_new_node_first_in_queue == 0) {
-        new_node->next = queue->first->next;
-        queue->first->next = new_node;
-        return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    node->priority.pointer = priority_copy;
+    return true;
+}
+
+/**
+ * pqNodeCopied: Checks if copying the element and priority into a node succeeded
+ * @param queue
+ * @param node
+ * @return
+ *      false if one of the copies failed
+ *      true otherwise
+ */
+inline static bool pqNodeCopied(PriorityQueue queue, pqNode node) {
+    return node->element != NULL && (queue->copyPriority == NULL || node->priority.pointer != NULL);
+}
+
+/**
+ * pqNodeCopyInto: Creates a copy of a node in new_entries, with copies of its element and priority
+ * @param queue - the queue the node belongs to
+ * @param new_entries
+ * @param node
+ * @return
+ *      NULL if memory allocation or one of the copies failed
+ *      the copy otherwise
+ */
+static pqNode pqNodeCopyInto(PriorityQueue queue, pqEntries new_entries, pqNode node) {
+    if (queue->capacity == 0) {
+        pqNode copy = pqNodeCopy(new_entries->pool, node, queue->copyElement, queue->copyPriority);
+        if (copy != NULL && pqNodeCopied(queue, copy) == false) {
+            pqNodeFree(new_entries->pool, copy, queue->freeElement, queue->freePriority);
+            return NULL;
+        }
+        return copy;
     }
-    pqNode temp = queue->first;
-    if (temp == NULL || temp->element == NULL || temp->priority == NULL) {
-        return PQ_OUT_OF_MEMORY;
+    pqNode copy = pqNodeCreate(new_entries->pool, NULL, NULL, NULL);
+    if (copy == NULL) {
+        return NULL;
     }
-    if (pqNodeGetNext(queue->first) == NULL) {
-        if (temp == NULL || temp->element == NULL || temp->priority == NULL) {
-            return PQ_OUT_OF_MEMORY;
+    char *slot = pqNodeSlot(queue, new_entries, copy);
+    memcpy(slot, pqNodeGetElement(node), queue->slot_size);
+    copy->element = (PQElement) slot;
+    copy->priority.pointer = (PQElementPriority) (slot + queue->priority_offset);
+    copy->sequence = node->sequence;
+    return copy;
+}
+
+/**
+ * pqHeapCopyNodes: Copies all the nodes in the heap of entries into the heap of new_entries, keeping their positions
+ * @param queue - the queue the entries belong to
+ * @param entries
+ * @param new_entries
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqHeapCopyNodes(PriorityQueue queue, pqEntries entries, pqEntries new_entries) {
+    int size = pqHeapGetSize(entries->heap);
+    for (int i = 0; i < size; i++) {
+        if (pqHeapGet(entries->heap, i)->dead) {
+            continue;
         }
-        temp->next = new_node;
-        queue->first = temp;
-        return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
-    }
-    pqNode temp_next = pqNodeGetNext(temp);
-    while (temp_next != NULL) {
-        int priority_new_node_temp_next = queue->comparePriorities(new_node->priority, pqNodeGetPriority(temp_next));
-        if (priority_new_node_temp_next > 0) {
-            new_node->next = temp_next;
-            temp->next = new_node;
-            return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
-        }
-        if (priority_new_node_temp_next == 0) {
-            bool next_is_also_same_priority = false;
-            if (temp_next->next != NULL &&
-                queue->comparePriorities(new_node->priority, pqNodeGetPriority(temp_next->next)) == 0) {
-                next_is_also_same_priority = true;
-            }
-            if (next_is_also_same_priority == false) {
-                new_node->next = temp_next->next;
-                temp_next->next = new_node;
-                return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
-            }
+        pqNode copy = pqNodeCopyInto(queue, new_entries, pqHeapGet(entries->heap, i));
+        if (copy == NULL) {
+            return false;
         }
-        temp = pqNodeGetNext(temp);
-        temp_next = pqNodeGetNext(temp_next);
+        if (pqHeapPush(new_entries->heap, copy) == false) {
+            pqNodeFree(new_entries->pool, copy, queue->freeElement, queue->freePriority);
+            return false;
+        }
+        pqIndexAdd(new_entries->index, copy);
+        new_entries->size = new_entries->size + 1;
     }
-    temp->next = new_node;
-    return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    return true;
 }
 
-PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element, PQElementPriority old_priority,
-                                     PQElementPriority new_priority) {
-    if (queue == NULL || element == NULL || old_priority == NULL || new_priority == NULL) {
-        return PQ_NULL_ARGUMENT;
-    }
-    if (pqContainsWithPriority(queue, element, old_priority) == false) {
-        return PQ_ELEMENT_DOES_NOT_EXISTS;
+/**
+ * pqArrayCopyNodes: Copies all the nodes in the array of entries into the array of new_entries in order, so each
+ * copy is pushed after the others
+ * @param queue - the queue the entries belong to
+ * @param entries
+ * @param new_entries
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqArrayCopyNodes(PriorityQueue queue, pqEntries entries, pqEntries new_entries) {
+    int size = pqArrayGetSize(entries->array);
+    if (pqArrayReserve(new_entries->array, size) == false) {
+        return false;
     }
-    if (pqRemoveElementAndPriority(queue, element, old_priority) == PQ_SUCCESS) {
-        return pqInsert(queue, element, new_priority);
+    for (int i = 0; i < size; i++) {
+        if (pqArrayGet(entries->array, i)->dead) {
+            continue;
+        }
+        pqNode copy = pqNodeCopyInto(queue, new_entries, pqArrayGet(entries->array, i));
+        if (copy == NULL) {
+            return false;
+        }
+        pqArrayPush(new_entries->array, copy);
+        pqIndexAdd(new_entries->index, copy);
+        new_entries->size = new_entries->size + 1;
     }
-    return PQ_ERROR;
+    return true;
 }
 
-PriorityQueueResult pqRemove(PriorityQueue queue) {
-    if (queue == NULL) {
-        return PQ_NULL_ARGUMENT;
-    }
+/**
+ * pqBucketsCopyNodes: Copies all the nodes in the buckets of entries into the buckets of new_entries, in the order
+ * of the buckets so nodes of equal priority keep their order
+ * @param queue - the queue the entries belong to
+ * @param entries
+ * @param new_entries
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqBucketsCopyNodes(PriorityQueue queue, pqEntries entries, pqEntries new_entries) {
+    for (pqNode node = pqBucketsFirst(queue, entries); node != NULL; node = pqBucketsNext(queue, entries, node)) {
+        if (node->dead) {
+            continue;
+        }
+        pqNode copy = pqNodeCopyInto(queue, new_entries, node);
+        if (copy == NULL) {
+            return false;
+        }
+        pqBucketsPush(queue, new_entries, copy);
+        pqIndexAdd(new_entries->index, copy);
+        new_entries->size = new_entries->size + 1;
+    }
+    return true;
+}
+
+/**
+ * pqListCopyNodes: Copies all the nodes in the list of entries into the list of new_entries, in the same order.
+ * The list is walked iteratively, so the length of the list is not limited by the stack
+ * @param queue - the queue the entries belong to
+ * @param entries
+ * @param new_entries
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqListCopyNodes(PriorityQueue queue, pqEntries entries, pqEntries new_entries) {
+    pqNode last = NULL;
+    for (pqNode node = entries->first; node != NULL; node = pqNodeGetNext(node)) {
+        if (node->dead) {
+            continue;
+        }
+        pqNode copy = pqNodeCopyInto(queue, new_entries, node);
+        if (copy == NULL) {
+            return false;
+        }
+        copy->next = NULL;
+        copy->prev = last;
+        if (last == NULL) {
+            new_entries->first = copy;
+        } else {
+            last->next = copy;
+        }
+        last = copy;
+        new_entries->last = copy;
+        pqIndexAdd(new_entries->index, copy);
+        new_entries->size = new_entries->size + 1;
+    }
+    return true;
+}
+
+/**
+ * pqEntriesGetNodes: Lists all the nodes of the entries of queue, in the order of the list, of the heap's array or of
+ * the buckets of the radix heap or the wheel. The nodes of an array are listed in the order of the queue
+ * @param queue
+ * @return
+ *      NULL if memory allocation failed
+ *      an array of the queue's size nodes otherwise
+ */
+static pqNode *pqEntriesGetNodes(PriorityQueue queue) {
+    pqEntries entries = queue->entries;
+    pqNode *nodes = malloc(sizeof(*nodes) * entries->size);
+    PQ_COUNT_ALLOCATION(nodes, sizeof(*nodes) * entries->size);
+    if (nodes == NULL) {
+        return NULL;
+    }
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        for (int i = 0; i < entries->size; i++) {
+            nodes[i] = pqHeapGet(entries->heap, i);
+        }
+        return nodes;
+    }
+    if (queue->backend == PQ_BACKEND_ARRAY) {
+        for (int i = 0; i < entries->size; i++) {
+            nodes[i] = pqArrayGet(entries->array, i);
+        }
+        return nodes;
+    }
+    int i = 0;
+    if (pqUsesBuckets(queue)) {
+        for (pqNode node = pqBucketsFirst(queue, entries); node != NULL; node = pqBucketsNext(queue, entries, node)) {
+            nodes[i] = node;
+            i = i + 1;
+        }
+        return nodes;
+    }
+    for (pqNode node = entries->first; node != NULL; node = pqNodeGetNext(node)) {
+        nodes[i] = node;
+        i = i + 1;
+    }
+    return nodes;
+}
+
+/**
+ * pqListSkipDead: Skips the tombstones in a list, from a certain node on
+ * @param node
+ * @return
+ *      the first node from node on that isn't a tombstone, NULL if there is none
+ */
+static pqNode pqListSkipDead(pqNode node) {
+    while (node != NULL && node->dead) {
+        node = pqNodeGetNext(node);
+    }
+    return node;
+}
+
+/**
+ * pqWheelSkipDead: Skips the tombstones in a wheel walked in order, from a certain node on
+ * @param wheel
+ * @param node
+ * @return
+ *      the first node from node on that isn't a tombstone, NULL if there is none
+ */
+static pqNode pqWheelSkipDead(pqWheel wheel, pqNode node) {
+    while (node != NULL && node->dead) {
+        node = pqWheelOrderedNext(wheel, node);
+    }
+    return node;
+}
+
+/**
+ * pqIteratorStart: Sets an iterator to the first element of its queue. PQ_BACKEND_LIST and PQ_BACKEND_WHEEL are
+ * walked in place, the wheel sorting each slot as the walk enters it. With the other backends this takes a sorted
+ * snapshot of the nodes that the following pqIteratorAdvance calls walk through, without the tombstones.
+ * PQ_BACKEND_ARRAY keeps its nodes in order, so its snapshot needs no sort
+ * @param iterator
+ * @return
+ *      NULL if the queue is empty or memory allocation failed
+ *      the first element otherwise
+ */
+static PQElement pqIteratorStart(PQIterator iterator) {
+    PriorityQueue queue = iterator->queue;
+    pqIteratorReset(iterator);
+    iterator->version = queue->entries->version;
+    if (queue->entries->size == 0) {
+        return NULL;
+    }
+    if (queue->backend == PQ_BACKEND_LIST) {
+        iterator->current = pqListSkipDead(queue->entries->first);
+        return pqNodeGetElement(iterator->current);
+    }
+    if (queue->backend == PQ_BACKEND_WHEEL) {
+        pqWheel wheel = queue->entries->wheel;
+        iterator->current = pqWheelSkipDead(wheel, pqWheelOrderedFirst(wheel));
+        return pqNodeGetElement(iterator->current);
+    }
+    if (isPQEmpty(queue)) {
+        return NULL;
+    }
+    pqNode *order = pqEntriesGetNodes(queue);
+    if (order == NULL) {
+        return NULL;
+    }
+    int count = 0;
+    for (int i = 0; i < queue->entries->size; i++) {
+        if (order[i]->dead == false) {
+            order[count] = order[i];
+            count = count + 1;
+        }
+    }
+    iterator->order = order;
+    if (queue->backend != PQ_BACKEND_ARRAY && pqNodeSort(iterator->order, count, queue->comparePriorities) == false) {
+        pqIteratorReset(iterator);
+        return NULL;
+    }
+    iterator->count = count;
+    iterator->position = 0;
+    return pqNodeGetElement(iterator->order[0]);
+}
+
+/**
+ * pqIteratorAdvance: Advances an iterator to the next element in O(1), apart from sorting the slot of a wheel that the
+ * walk enters
+ * @param iterator
+ * @return
+ *      NULL if the iteration ended, or the queue was modified since it started
+ *      the next element otherwise
+ */
+static PQElement pqIteratorAdvance(PQIterator iterator) {
+    if (iterator->version != iterator->queue->entries->version) {
+        return NULL;
+    }
+    if (iterator->queue->backend == PQ_BACKEND_LIST) {
+        iterator->current = pqListSkipDead(pqNodeGetNext(iterator->current));
+        return pqNodeGetElement(iterator->current);
+    }
+    if (iterator->queue->backend == PQ_BACKEND_WHEEL) {
+        if (iterator->current == NULL) {
+            return NULL;
+        }
+        pqWheel wheel = iterator->queue->entries->wheel;
+        iterator->current = pqWheelSkipDead(wheel, pqWheelOrderedNext(wheel, iterator->current));
+        return pqNodeGetElement(iterator->current);
+    }
+    if (iterator->order == NULL || iterator->position + 1 >= iterator->count) {
+        return NULL;
+    }
+    iterator->position = iterator->position + 1;
+    return pqNodeGetElement(iterator->order[iterator->position]);
+}
+
+/**
+ * pqListLinkAfter: Links a node into the list right after another node, keeping both directions of the list linked
+ * @param queue
+ * @param before - the node to link after, or NULL to link the node first
+ * @param node
+ */
+static void pqListLinkAfter(PriorityQueue queue, pqNode before, pqNode node) {
+    node->prev = before;
+    if (before == NULL) {
+        node->next = queue->entries->first;
+        queue->entries->first = node;
+    } else {
+        node->next = before->next;
+        before->next = node;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node;
+    } else {
+        queue->entries->last = node;
+    }
+}
+
+/**
+ * pqListLink: Links a node into its place in the list, after all the nodes that come before it by pqNodeCompare.
+ * A node that comes before the first node is linked first, otherwise the list is scanned backwards from its last
+ * node. Since a node being linked has the newest sequence, it goes right after the nodes of equal priority, and the
+ * run of equal priorities is never scanned
+ * @param queue
+ * @param new_node
+ * @return
+ *      PQ_SUCCESS
+ */
+static PriorityQueueResult pqListLink(PriorityQueue queue, pqNode new_node) {
+    pqNode first = queue->entries->first;
+    if (first == NULL || pqNodeCompare(new_node, first, queue->comparePriorities) > 0) {
+        pqListLinkAfter(queue, NULL, new_node);
+        return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    }
+    pqNode before = queue->entries->last;
+    PQ_COUNT(insert_traversals, 1);
+    while (pqNodeCompare(new_node, before, queue->comparePriorities) > 0) {
+        before = before->prev;
+        PQ_COUNT(insert_traversals, 1);
+    }
+    pqListLinkAfter(queue, before, new_node);
+    return pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+}
+
+/**
+ * pqListUnlink: Unlinks a node from the list in O(1) without freeing it
+ * @param queue
+ * @param node - a node that is linked in the list
+ */
+static void pqListUnlink(PriorityQueue queue, pqNode node) {
+    if (node->prev == NULL) {
+        queue->entries->first = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    } else {
+        queue->entries->last = node->prev;
+    }
+    node->next = NULL;
+    node->prev = NULL;
+    pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
+}
+
+/**
+ * pqListFindNode: Finds the first node in the list that has a certain element with a certain priority (can be set
+ * to NULL as to ignore priority)
+ * @param queue
+ * @param element
+ * @param priority
+ * @return
+ *      NULL if no such node exists
+ *      the node otherwise
+ */
+static pqNode pqListFindNode(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    pqNode node = queue->entries->first;
+    while (node != NULL) {
+        if (pqNodeSame(queue, element, priority, node)) {
+            return node;
+        }
+        node = node->next;
+    }
+    return NULL;
+}
+
+/**
+ * pqNodeChangePriority: Gives a linked node a new priority and moves it to its new place, as if it was reinserted.
+ * Only the new priority is copied, the node and its element stay where they are in memory, and in a scalar queue
+ * nothing is allocated at all. An array node is found by its old priority, so it is taken out of the array first and
+ * pushed again after, into the room it freed
+ * @param queue
+ * @param node
+ * @param new_priority
+ * @return
+ *      PQ_OUT_OF_MEMORY if copying the priority failed, the node is unchanged in that case
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqNodeChangePriority(PriorityQueue queue, pqNode node, PQElementPriority new_priority) {
+    if (queue->backend == PQ_BACKEND_ARRAY) {
+        pqArrayRemove(queue->entries->array, node);
+    }
+    if (pqNodeSetPriority(queue, node, new_priority) == false) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    setIteratorToNULL(queue);
+    PQ_COUNT(inserts, 1);
+    node->sequence = queue->entries->next_sequence;
+    queue->entries->next_sequence = queue->entries->next_sequence + 1;
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        pqHeapUpdate(queue->entries->heap, node->index);
+        return PQ_SUCCESS;
+    }
+    if (queue->backend == PQ_BACKEND_ARRAY) {
+        pqArrayPush(queue->entries->array, node);
+        return PQ_SUCCESS;
+    }
+    if (queue->backend == PQ_BACKEND_RADIX) {
+        pqRadixUpdate(queue->entries->radix, node);
+        return PQ_SUCCESS;
+    }
+    if (queue->backend == PQ_BACKEND_WHEEL) {
+        pqWheelUpdate(queue->entries->wheel, node);
+        return PQ_SUCCESS;
+    }
+    pqListUnlink(queue, node);
+    return pqListLink(queue, node);
+}
+
+/**
+ * pqFindNode: Finds the highest priority node that has a certain element with a certain priority (can be set to NULL
+ * as to ignore priority), through the index if the queue has one
+ * @param queue
+ * @param element
+ * @param priority
+ * @return
+ *      NULL if no such node exists
+ *      the node otherwise
+ */
+static pqNode pqFindNode(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    PQ_COUNT(lookups, 1);
+    if (queue->entries->index != NULL) {
+        return pqIndexFind(queue->entries->index, element, priority, queue->comparePriorities);
+    }
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        return pqHeapFindNode(queue, element, priority);
+    }
+    if (queue->backend == PQ_BACKEND_ARRAY) {
+        return pqArrayFindNode(queue, element, priority);
+    }
+    if (pqUsesBuckets(queue)) {
+        return pqBucketsFindNode(queue, element, priority);
+    }
+    return pqListFindNode(queue, element, priority);
+}
+
+/**
+ * pqUnlinkNode: Removes a node from the queue and its index without freeing it, a tombstone was already removed from
+ * the index
+ * @param queue
+ * @param node
+ */
+static void pqUnlinkNode(PriorityQueue queue, pqNode node) {
+    setIteratorToNULL(queue);
+    if (node->dead) {
+        queue->entries->dead = queue->entries->dead - 1;
+    } else {
+        pqIndexRemove(queue->entries->index, node);
+    }
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        pqHeapRemoveAt(queue->entries->heap, node->index);
+        pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
+    } else if (queue->backend == PQ_BACKEND_ARRAY) {
+        pqArrayRemove(queue->entries->array, node);
+        pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
+    } else if (queue->backend == PQ_BACKEND_RADIX) {
+        pqRadixRemove(queue->entries->radix, node);
+        pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
+    } else if (queue->backend == PQ_BACKEND_WHEEL) {
+        pqWheelRemove(queue->entries->wheel, node);
+        pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
+    } else {
+        pqListUnlink(queue, node);
+    }
+}
+
+/**
+ * pqRemoveNode: Removes a node from the queue and frees it
+ * @param queue
+ * @param node
+ * @return
+ *      PQ_SUCCESS
+ */
+static PriorityQueueResult pqRemoveNode(PriorityQueue queue, pqNode node) {
+    pqUnlinkNode(queue, node);
+    pqNodeFree(queue->entries->pool, node, queue->freeElement, queue->freePriority);
+    return PQ_SUCCESS;
+}
+
+/**
+ * pqFirstNode: Retrieve the highest priority node of a queue that isn't empty
+ * @param queue
+ * @return
+ *      the first node of the queue
+ */
+static pqNode pqFirstNode(PriorityQueue queue) {
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        return pqHeapTop(queue->entries->heap);
+    }
+    if (queue->backend == PQ_BACKEND_ARRAY) {
+        return pqArrayTop(queue->entries->array);
+    }
+    if (queue->backend == PQ_BACKEND_RADIX) {
+        return pqRadixTop(queue->entries->radix);
+    }
+    if (queue->backend == PQ_BACKEND_WHEEL) {
+        return pqWheelTop(queue->entries->wheel);
+    }
+    return queue->entries->first;
+}
+
+/**
+ * pqFirstLiveNode: Retrieve the highest priority node of a queue that isn't empty, removing the tombstones before it
+ * @param queue
+ * @return
+ *      the first node of the queue that isn't a tombstone
+ */
+static pqNode pqFirstLiveNode(PriorityQueue queue) {
+    pqNode node = pqFirstNode(queue);
+    while (node->dead) {
+        pqRemoveNode(queue, node);
+        node = pqFirstNode(queue);
+    }
+    return node;
+}
+
+/**
+ * pqCreateArgumentsValid: Checks the arguments given to the pqCreate functions
+ * @return
+ *      TRUE if none of the functions is NULL and the backend is known
+ *      FALSE otherwise
+ */
+static bool pqCreateArgumentsValid(PQBackend backend,
+                                   CopyPQElement copy_element,
+                                   FreePQElement free_element,
+                                   EqualPQElements equal_elements,
+                                   CopyPQElementPriority copy_priority,
+                                   FreePQElementPriority free_priority,
+                                   ComparePQElementPriorities compare_priorities) {
+    if (copy_element == NULL || free_element == NULL || equal_elements == NULL ||
+        copy_priority == NULL || free_priority == NULL || compare_priorities == NULL) {
+        return false;
+    }
+    return backend == PQ_BACKEND_LIST || backend == PQ_BACKEND_HEAP;
+}
+
+/**
+ * pqEntriesDestroy: Frees the entries with all their nodes at once. The elements and priorities of the nodes are
+ * freed with the free functions of queue, unless it was declared trivially destructible
+ * @param queue - a queue the entries belong to
+ * @param entries
+ */
+static void pqEntriesDestroy(PriorityQueue queue, pqEntries entries) {
+    if (queue->trivialDestruction == false && entries->heap != NULL) {
+        int size = pqHeapGetSize(entries->heap);
+        for (int i = 0; i < size; i++) {
+            pqNodeFreeValues(pqHeapGet(entries->heap, i), queue->freeElement, queue->freePriority);
+        }
+    } else if (queue->trivialDestruction == false && entries->array != NULL) {
+        int size = pqArrayGetSize(entries->array);
+        for (int i = 0; i < size; i++) {
+            pqNodeFreeValues(pqArrayGet(entries->array, i), queue->freeElement, queue->freePriority);
+        }
+    } else if (queue->trivialDestruction == false && (entries->radix != NULL || entries->wheel != NULL)) {
+        for (pqNode node = pqBucketsFirst(queue, entries); node != NULL; node = pqBucketsNext(queue, entries, node)) {
+            pqNodeFreeValues(node, queue->freeElement, queue->freePriority);
+        }
+    } else if (queue->trivialDestruction == false) {
+        for (pqNode node = entries->first; node != NULL; node = pqNodeGetNext(node)) {
+            pqNodeFreeValues(node, queue->freeElement, queue->freePriority);
+        }
+    }
+    pqHeapDestroy(entries->heap);
+    pqArrayDestroy(entries->array);
+    pqRadixDestroy(entries->radix);
+    pqWheelDestroy(entries->wheel);
+    pqIndexDestroy(entries->index);
+    pqNodePoolDestroy(entries->pool);
+    free(entries->storage);
+    free(entries);
+}
+
+/**
+ * pqEntriesReserve: Allocates everything the entries of a bounded queue will ever need at once: the storage of the
+ * values, the nodes and the array of the heap, so nothing is allocated while the queue is used
+ * @param queue
+ * @param entries
+ * @return
+ *      false if memory allocation failed
+ *      true otherwise
+ */
+static bool pqEntriesReserve(PriorityQueue queue, pqEntries entries) {
+    entries->storage = malloc(queue->slot_size * (size_t) queue->capacity);
+    return entries->storage != NULL && pqNodePoolReserve(entries->pool, queue->capacity) &&
+           (entries->heap == NULL || pqHeapReserve(entries->heap, queue->capacity));
+}
+
+/**
+ * pqEntriesCreate: Allocates new empty entries for queue, with a heap if the queue uses PQ_BACKEND_HEAP, a concurrent
+ * one if the queue has fine-grained locking, and an index if it has a hash function. The entries are owned by queue
+ * alone
+ * @param queue
+ * @return
+ *      NULL if allocations failed
+ *      the new entries otherwise
+ */
+static pqEntries pqEntriesCreate(PriorityQueue queue) {
+    pqEntries entries = malloc(sizeof(*entries));
+    if (entries == NULL) {
+        return NULL;
+    }
+    entries->refs = 1;
+    entries->owner = queue;
+    entries->size = 0;
+    entries->dead = 0;
+    entries->first = NULL;
+    entries->last = NULL;
+    entries->next_sequence = 0;
+    entries->version = 0;
+    entries->storage = NULL;
+    entries->heap = NULL;
+    entries->array = NULL;
+    entries->radix = NULL;
+    entries->wheel = NULL;
+    entries->index = NULL;
+    entries->pool = pqNodePoolCreate();
+    if (entries->pool == NULL) {
+        pqEntriesDestroy(queue, entries);
+        return NULL;
+    }
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        entries->heap = pqHeapCreate(queue->comparePriorities);
+        if (entries->heap == NULL || (pqFineGrained(queue) && pqHeapMakeConcurrent(entries->heap) == false)) {
+            pqEntriesDestroy(queue, entries);
+            return NULL;
+        }
+    }
+    if (queue->backend == PQ_BACKEND_ARRAY) {
+        entries->array = pqArrayCreate();
+        if (entries->array == NULL) {
+            pqEntriesDestroy(queue, entries);
+            return NULL;
+        }
+    }
+    if (queue->backend == PQ_BACKEND_RADIX) {
+        entries->radix = pqRadixCreate();
+        if (entries->radix == NULL) {
+            pqEntriesDestroy(queue, entries);
+            return NULL;
+        }
+    }
+    if (queue->backend == PQ_BACKEND_WHEEL) {
+        entries->wheel = pqWheelCreate();
+        if (entries->wheel == NULL) {
+            pqEntriesDestroy(queue, entries);
+            return NULL;
+        }
+    }
+    if (queue->hashElement != NULL) {
+        entries->index = pqIndexCreate(queue->hashElement, queue->equalElements);
+        if (entries->index == NULL) {
+            pqEntriesDestroy(queue, entries);
+            return NULL;
+        }
+    }
+    if (queue->capacity > 0 && pqEntriesReserve(queue, entries) == false) {
+        pqEntriesDestroy(queue, entries);
+        return NULL;
+    }
+    return entries;
+}
+
+/**
+ * pqEntriesCopy: Creates a deep copy of the entries of queue, copying every element and priority, and leaving the
+ * tombstones out
+ * @param queue
+ * @return
+ *      NULL if memory allocation or one of the copies failed
+ *      the new entries otherwise, owned by queue alone
+ */
+static pqEntries pqEntriesCopy(PriorityQueue queue) {
+    pqEntries entries = queue->entries;
+    pqEntries new_entries = pqEntriesCreate(queue);
+    if (new_entries == NULL) {
+        return NULL;
+    }
+    new_entries->next_sequence = entries->next_sequence;
+    bool copied;
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        copied = pqHeapCopyNodes(queue, entries, new_entries);
+    } else if (queue->backend == PQ_BACKEND_ARRAY) {
+        copied = pqArrayCopyNodes(queue, entries, new_entries);
+    } else if (pqUsesBuckets(queue)) {
+        copied = pqBucketsCopyNodes(queue, entries, new_entries);
+    } else {
+        copied = pqListCopyNodes(queue, entries, new_entries);
+    }
+    if (copied == false) {
+        pqEntriesDestroy(queue, new_entries);
+        return NULL;
+    }
+    return new_entries;
+}
+
+/**
+ * pqEntriesRelease: Stops a queue from using its entries, and destroys them if no other queue shares them
+ * @param queue
+ */
+static void pqEntriesRelease(PriorityQueue queue) {
+    pqEntries entries = queue->entries;
+    queue->entries = NULL;
+    if (entries->refs > 1) {
+        entries->refs = entries->refs - 1;
+        if (entries->owner == queue) {
+            entries->owner = NULL;
+        }
+        return;
+    }
+    pqEntriesDestroy(queue, entries);
+}
+
+/**
+ * pqDetach: Gives a queue entries of its own before it modifies them. Entries shared with copies of the queue are
+ * copied, and the queue keeps using the copy. If the queue is the owner of the shared entries, their nodes stay with
+ * the queue so its handles remain valid, and the copy is left for the other queues instead.
+ * Called by every function that modifies the queue, before it looks for nodes
+ * @param queue
+ * @return
+ *      PQ_OUT_OF_MEMORY if copying the entries failed, the queue is unchanged in that case
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqDetach(PriorityQueue queue) {
+    pqEntries shared = queue->entries;
+    if (shared->refs == 1) {
+        return PQ_SUCCESS;
+    }
+    pqEntries copy = pqEntriesCopy(queue);
+    if (copy == NULL) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    if (shared->owner == queue) {
+        struct pqEntries_t nodes = *shared;
+        shared->size = copy->size;
+        shared->dead = copy->dead;
+        shared->first = copy->first;
+        shared->last = copy->last;
+        shared->pool = copy->pool;
+        shared->heap = copy->heap;
+        shared->array = copy->array;
+        shared->radix = copy->radix;
+        shared->wheel = copy->wheel;
+        shared->index = copy->index;
+        shared->owner = NULL;
+        shared->version = shared->version + 1;
+        copy->size = nodes.size;
+        copy->dead = nodes.dead;
+        copy->first = nodes.first;
+        copy->last = nodes.last;
+        copy->pool = nodes.pool;
+        copy->heap = nodes.heap;
+        copy->array = nodes.array;
+        copy->radix = nodes.radix;
+        copy->wheel = nodes.wheel;
+        copy->index = nodes.index;
+    }
+    copy->version = shared->version + 1;
+    shared->refs = shared->refs - 1;
+    pqIteratorReset(&queue->iterator);
+    queue->entries = copy;
+    return PQ_SUCCESS;
+}
+
+/**
+ * pqFindNodeToModify: Finds a node like pqFindNode, in entries the queue can modify. Shared entries are only detached
+ * if the node exists in them
+ * @param queue
+ * @param element
+ * @param priority
+ * @param result - set to the result of detaching the entries
+ * @return
+ *      NULL if no such node exists, or detaching the entries failed
+ *      the node otherwise
+ */
+static pqNode pqFindNodeToModify(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                 PriorityQueueResult *result) {
+    *result = PQ_SUCCESS;
+    pqNode node = pqFindNode(queue, element, priority);
+    if (node == NULL || queue->entries->refs == 1) {
+        return node;
+    }
+    *result = pqDetach(queue);
+    if (*result != PQ_SUCCESS) {
+        return NULL;
+    }
+    return pqFindNode(queue, element, priority);
+}
+
+/**
+ * pqCreateFull: Allocates a new empty priority queue with a specific backend, and an index if hash_element is not
+ * NULL
+ * @return
+ *      NULL if allocations failed
+ *      A new priority queue in case of success
+ */
+static PriorityQueue pqCreateFull(PQBackend backend,
+                                  CopyPQElement copy_element,
+                                  FreePQElement free_element,
+                                  EqualPQElements equal_elements,
+                                  CopyPQElementPriority copy_priority,
+                                  FreePQElementPriority free_priority,
+                                  ComparePQElementPriorities compare_priorities,
+                                  HashPQElement hash_element) {
+    PriorityQueue queue = malloc(sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->backend = backend;
+    queue->copyElement = copy_element;
+    queue->freeElement = free_element;
+    queue->equalElements = equal_elements;
+    queue->copyPriority = copy_priority;
+    queue->freePriority = free_priority;
+    queue->comparePriorities = compare_priorities;
+    queue->hashElement = hash_element;
+    queue->trivialDestruction = false;
+    queue->concurrent = false;
+    queue->sub_queues = NULL;
+    queue->sub_queue_count = 0;
+    queue->flush_policy = PQ_FLUSH_ON_READ;
+    queue->buffer_size = 0;
+    queue->buffers = NULL;
+    queue->flushes = 0;
+    queue->flushed = 0;
+    queue->capacity = 0;
+    queue->element_size = 0;
+    queue->priority_size = 0;
+    queue->priority_offset = 0;
+    queue->slot_size = 0;
+    queue->compaction_fraction = 0;
+    queue->compactions = 0;
+    queue->compaction_seconds = 0;
+    queue->entries = pqEntriesCreate(queue);
+    if (queue->entries == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pqStatsReset(queue);
+    pqIteratorInit(&queue->iterator, queue);
+    return queue;
+}
+
+/**
+ * pqLinkNewNode: Gives a new node the next insertion sequence and links it into the queue and its index
+ * @param queue
+ * @param new_node
+ * @param handle - receives the handle of the node if not NULL
+ * @return
+ *      PQ_OUT_OF_MEMORY if linking the node failed, the queue is unchanged in that case
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqLinkNewNode(PriorityQueue queue, pqNode new_node, PQHandle *handle) {
+    PQ_COUNT(inserts, 1);
+    new_node->sequence = queue->entries->next_sequence;
+    queue->entries->next_sequence = queue->entries->next_sequence + 1;
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        if (pqHeapPush(queue->entries->heap, new_node) == false) {
+            return PQ_OUT_OF_MEMORY;
+        }
+        pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    } else if (queue->backend == PQ_BACKEND_ARRAY) {
+        if (pqArrayPush(queue->entries->array, new_node) == false) {
+            return PQ_OUT_OF_MEMORY;
+        }
+        pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    } else if (pqUsesBuckets(queue)) {
+        pqBucketsPush(queue, queue->entries, new_node);
+        pqUpdateSizeAfterInsertAndReturnSuccess(queue);
+    } else if (pqListLink(queue, new_node) != PQ_SUCCESS) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    pqIndexAdd(queue->entries->index, new_node);
+    if (handle != NULL) {
+        *handle = (PQHandle) new_node;
+    }
+    return PQ_SUCCESS;
+}
+
+/**
+ * pqListMergeSorted: Merges a sorted array of new nodes into the list in one pass over both, O(n + count)
+ * @param queue
+ * @param sorted - new nodes sorted by pqNodeCompare
+ * @param count - the amount of nodes in the array
+ */
+static void pqListMergeSorted(PriorityQueue queue, pqNode *sorted, int count) {
+    pqNode before = NULL;
+    pqNode node = queue->entries->first;
+    for (int i = 0; i < count; i++) {
+        while (node != NULL && pqNodeCompare(node, sorted[i], queue->comparePriorities) > 0) {
+            PQ_COUNT(insert_traversals, 1);
+            before = node;
+            node = node->next;
+        }
+        pqListLinkAfter(queue, before, sorted[i]);
+        before = sorted[i];
+    }
+    queue->entries->size = queue->entries->size + count;
+}
+
+/**
+ * pqNodeTakePriority: Gives a node a priority without copying it, the node owns the priority from then on
+ * @param queue
+ * @param node
+ * @param priority
+ */
+inline static void pqNodeTakePriority(PriorityQueue queue, pqNode node, PQElementPriority priority) {
+    if (queue->comparePriorities == NULL) {
+        node->priority.scalar = *(PQScalarPriority *) priority;
+    } else {
+        node->priority.pointer = priority;
+    }
+}
+
+/**
+ * pqBatchFreeNodes: Frees the nodes created for a batch that could not be inserted
+ * @param queue
+ * @param nodes
+ * @param count - the amount of nodes created so far
+ * @param take - whether the nodes were given the caller's elements and priorities, which are then left to the caller
+ */
+static void pqBatchFreeNodes(PriorityQueue queue, pqNode *nodes, int count, bool take) {
+    for (int i = 0; i < count; i++) {
+        if (take) {
+            nodes[i]->element = NULL;
+            nodes[i]->priority.pointer = NULL;
+        }
+        pqNodeFree(queue->entries->pool, nodes[i], queue->freeElement, queue->freePriority);
+    }
+    free(nodes);
+}
+
+/**
+ * pqBatchCreateNodes: Creates a node for every element and priority of a batch, with copies of both and the insertion
+ * sequences that follow the queue's. All the nodes missing from the pool are allocated at once
+ * @param queue
+ * @param elements
+ * @param priorities
+ * @param count
+ * @param take - whether the nodes take the elements and priorities themselves instead of copies, as pqInsertTake
+ * @return
+ *      NULL if memory allocation or one of the copies failed, nothing is left allocated in that case
+ *      an array of the new nodes otherwise
+ */
+static pqNode *pqBatchCreateNodes(PriorityQueue queue, PQElement *elements, PQElementPriority *priorities,
+                                  int count, bool take) {
+    pqNode *nodes = malloc(sizeof(*nodes) * count);
+    PQ_COUNT_ALLOCATION(nodes, sizeof(*nodes) * count);
+    if (nodes == NULL) {
+        return NULL;
+    }
+    if (pqNodePoolReserve(queue->entries->pool, count) == false) {
+        free(nodes);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        if (take) {
+            nodes[i] = pqNodeCreate(queue->entries->pool, elements[i], NULL, NULL);
+            pqNodeTakePriority(queue, nodes[i], priorities[i]);
+        } else {
+            nodes[i] = pqNodeCreate(queue->entries->pool, NULL, NULL, NULL);
+            if (pqNodeSetElement(queue, nodes[i], elements[i]) == false ||
+                pqNodeSetPriority(queue, nodes[i], priorities[i]) == false) {
+                pqBatchFreeNodes(queue, nodes, i + 1, false);
+                return NULL;
+            }
+        }
+        nodes[i]->sequence = queue->entries->next_sequence + i;
+    }
+    return nodes;
+}
+
+/**
+ * pqBatchInsert: Inserts a non empty batch of elements with their priorities, as if they were inserted one by one.
+ * The nodes of a heap are pushed at once, rebuilding the heap if they outnumber it, the nodes of an array, a radix
+ * heap or a wheel are pushed in order, and the nodes of a list are sorted and merged with it in one pass
+ * @param queue
+ * @param elements
+ * @param priorities
+ * @param count
+ * @param take - whether the queue takes the elements and priorities themselves instead of copies, as pqInsertTake
+ * @return
+ *      PQ_OUT_OF_MEMORY if memory allocation or one of the copies failed, the queue is unchanged in that case and
+ *      taken elements and priorities are left to the caller
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqBatchInsert(PriorityQueue queue, PQElement *elements, PQElementPriority *priorities,
+                                         int count, bool take) {
+    if (pqDetach(queue) != PQ_SUCCESS) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    setIteratorToNULL(queue);
+    PQ_COUNT(inserts, count);
+    pqNode *nodes = pqBatchCreateNodes(queue, elements, priorities, count, take);
+    if (nodes == NULL) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    if (queue->backend == PQ_BACKEND_HEAP) {
+        if (pqHeapPushAll(queue->entries->heap, nodes, count) == false) {
+            pqBatchFreeNodes(queue, nodes, count, take);
+            return PQ_OUT_OF_MEMORY;
+        }
+        queue->entries->size = queue->entries->size + count;
+    } else if (queue->backend == PQ_BACKEND_ARRAY) {
+        if (pqArrayPushAll(queue->entries->array, nodes, count) == false) {
+            pqBatchFreeNodes(queue, nodes, count, take);
+            return PQ_OUT_OF_MEMORY;
+        }
+        queue->entries->size = queue->entries->size + count;
+    } else if (pqUsesBuckets(queue)) {
+        for (int i = 0; i < count; i++) {
+            pqBucketsPush(queue, queue->entries, nodes[i]);
+        }
+        queue->entries->size = queue->entries->size + count;
+    } else {
+        if (pqNodeSort(nodes, count, queue->comparePriorities) == false) {
+            pqBatchFreeNodes(queue, nodes, count, take);
+            return PQ_OUT_OF_MEMORY;
+        }
+        pqListMergeSorted(queue, nodes, count);
+    }
+    for (int i = 0; i < count; i++) {
+        pqIndexAdd(queue->entries->index, nodes[i]);
+    }
+    queue->entries->next_sequence = queue->entries->next_sequence + count;
+    pqStatsNoteSize(queue);
+    free(nodes);
+    return PQ_SUCCESS;
+}
+
+/**
+ * pqMergeArgumentsValid: Checks that the entries of source can be moved into destination as they are, meaning both
+ * queues treat elements and priorities with the same functions
+ * @param destination
+ * @param source
+ * @return
+ *      TRUE if the queues are different queues with the same functions
+ *      FALSE otherwise
+ */
+static bool pqMergeArgumentsValid(PriorityQueue destination, PriorityQueue source) {
+    return destination != source &&
+           destination->copyElement == source->copyElement && destination->freeElement == source->freeElement &&
+           destination->equalElements == source->equalElements &&
+           destination->copyPriority == source->copyPriority && destination->freePriority == source->freePriority &&
+           destination->comparePriorities == source->comparePriorities;
+}
+
+/**
+ * pqMergeNodes: Links the nodes of source into destination, after their sequences were moved after the sequences of
+ * destination. Heap nodes are added to the heap of destination, rebuilding it if they outnumber it, and array nodes
+ * are sorted and merged with the array of destination. Otherwise the nodes are sorted unless they come from a list, and then
+ * merged with the list of destination in one pass or pushed in order into its buckets
+ * @param destination
+ * @param source
+ * @param nodes - all the nodes of source, as listed by pqEntriesGetNodes
+ * @return
+ *      false if memory allocation failed, destination is unchanged in that case
+ *      true otherwise
+ */
+static bool pqMergeNodes(PriorityQueue destination, PriorityQueue source, pqNode *nodes) {
+    int count = source->entries->size;
+    PQ_COUNT(inserts, count);
+    if (destination->backend == PQ_BACKEND_HEAP) {
+        if (pqHeapPushAll(destination->entries->heap, nodes, count) == false) {
+            return false;
+        }
+        destination->entries->size = destination->entries->size + count;
+        return true;
+    }
+    if (destination->backend == PQ_BACKEND_ARRAY) {
+        if (pqArrayPushAll(destination->entries->array, nodes, count) == false) {
+            return false;
+        }
+        destination->entries->size = destination->entries->size + count;
+        return true;
+    }
+    if (source->backend != PQ_BACKEND_LIST) {
+        if (pqNodeSort(nodes, count, destination->comparePriorities) == false) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            nodes[i]->index = NODE_NOT_IN_HEAP;
+        }
+    }
+    if (pqUsesBuckets(destination)) {
+        for (int i = 0; i < count; i++) {
+            pqBucketsPush(destination, destination->entries, nodes[i]);
+        }
+        destination->entries->size = destination->entries->size + count;
+        return true;
+    }
+    pqListMergeSorted(destination, nodes, count);
+    return true;
+}
+
+/**
+ * pqPopManyLocked: pqPopMany, called while holding the lock of the queue
+ */
+static int pqPopManyLocked(PriorityQueue queue, int k, PQElement *out_elements) {
+    if (queue == NULL || out_elements == NULL || k < 0) {
+        return ELEMENT_NOT_FOUND;
+    }
+    if (k == 0 || isPQEmpty(queue) == true) {
+        return 0;
+    }
+    if (pqDetach(queue) != PQ_SUCCESS) {
+        return ELEMENT_NOT_FOUND;
+    }
+    int count = 0;
+    while (count < k && isPQEmpty(queue) == false) {
+        pqNode node = pqFirstLiveNode(queue);
+        pqUnlinkNode(queue, node);
+        out_elements[count] = pqNodeGetElement(node);
+        node->element = NULL;
+        pqNodeFree(queue->entries->pool, node, queue->freeElement, queue->freePriority);
+        count = count + 1;
+    }
+    return count;
+}
+
+/**
+ * pqPopShared: Removes up to k of the highest priority elements of a queue with fine-grained locking under its shared
+ * lock, while other threads insert and pop. Each element is popped from the heap on its own, so the elements are in
+ * order, but the elements of other threads may be popped or inserted between them
+ * @param queue
+ * @param k
+ * @param out_elements - receives the elements, or NULL to free them instead
+ * @return
+ *      -1 if the queue can't be modified under its shared lock, see pqSharedPathOpen, it is unchanged then
+ *      the amount of elements removed otherwise, k or less if the queue ran out of elements
+ */
+static int pqPopShared(PriorityQueue queue, int k, PQElement *out_elements) {
+    pqLockShared(queue);
+    if (pqSharedPathOpen(queue) == false) {
+        pqUnlock(queue);
+        return ELEMENT_NOT_FOUND;
+    }
+    pqEntries entries = queue->entries;
+    int count = 0;
+    while (count < k) {
+        pqNode node = pqHeapConcurrentPop(entries->heap);
+        if (node == NULL) {
+            break;
+        }
+        __atomic_fetch_sub(&entries->size, 1, __ATOMIC_RELAXED);
+        if (out_elements != NULL) {
+            out_elements[count] = pqNodeGetElement(node);
+            node->element = NULL;
+        }
+        pthread_mutex_lock(&queue->nodes_lock);
+        setIteratorToNULL(queue);
+        pqNodeFree(entries->pool, node, queue->freeElement, queue->freePriority);
+        pthread_mutex_unlock(&queue->nodes_lock);
+        count = count + 1;
+    }
+    pqUnlock(queue);
+    return count;
+}
+
+/**
+ * pqRandomStateCreateKey: Creates the key of the random state of each thread, called once
+ */
+static void pqRandomStateCreateKey(void) {
+    pthread_key_create(&random_state_key, free);
+}
+
+/**
+ * pqRandom: Returns a pseudo-random number from a xorshift generator with a state for each thread, so threads
+ * don't share anything while choosing sub-queues
+ * @return
+ *      a pseudo-random number
+ */
+static unsigned long pqRandom(void) {
+    pthread_once(&random_state_once, pqRandomStateCreateKey);
+    unsigned long *state = pthread_getspecific(random_state_key);
+    if (state == NULL) {
+        state = malloc(sizeof(*state));
+        if (state == NULL) {
+            return 0;
+        }
+        *state = (unsigned long) (uintptr_t) state * 2654435761UL | 1;
+        pthread_setspecific(random_state_key, state);
+    }
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * pqRelaxedPick: Picks a random sub-queue of a relaxed queue
+ * @param queue
+ * @return
+ *      the sub-queue
+ */
+static PriorityQueue pqRelaxedPick(PriorityQueue queue) {
+    return queue->sub_queues[pqRandom() % queue->sub_queue_count];
+}
+
+/**
+ * pqRelaxedPopFrom: Removes the highest priority element of the better of two sub-queues, the one whose first
+ * element has the higher priority, and gives the element to the caller
+ * @param queue - a relaxed queue
+ * @param first - index of the first sub-queue
+ * @param second - index of the second sub-queue, can be the same as first
+ * @param element - receives the element
+ * @return
+ *      false if both sub-queues are empty
+ *      true otherwise
+ */
+static bool pqRelaxedPopFrom(PriorityQueue queue, int first, int second, PQElement *element) {
+    if (second < first) {
+        int temp = first;
+        first = second;
+        second = temp;
+    }
+    PriorityQueue first_queue = queue->sub_queues[first], second_queue = queue->sub_queues[second];
+    pqLockWrite(first_queue);
+    if (second != first) {
+        pqLockWrite(second_queue);
+    }
+    pqNode first_top = pqHeapTop(first_queue->entries->heap), second_top = pqHeapTop(second_queue->entries->heap);
+    PriorityQueue better = first_queue;
+    if (first_top == NULL ||
+        (second_top != NULL && pqNodeComparePriorities(second_top, first_top, queue->comparePriorities) > 0)) {
+        better = second_queue;
+    }
+    int count = pqPopManyLocked(better, 1, element);
+    if (second != first) {
+        pqUnlock(second_queue);
+    }
+    pqUnlock(first_queue);
+    return count == 1;
+}
+
+/**
+ * pqRelaxedPop: Removes a high priority element from a relaxed queue and gives it to the caller. The element is
+ * taken from the better of two random sub-queues, and only if they are both empty the sub-queues are searched in
+ * order, so an element is found as long as the queue isn't empty
+ * @param queue - a relaxed queue
+ * @param element - receives the element
+ * @return
+ *      false if the queue is empty
+ *      true otherwise
+ */
+static bool pqRelaxedPop(PriorityQueue queue, PQElement *element) {
+    for (int attempt = 0; attempt < RELAXED_POP_ATTEMPTS; attempt++) {
+        int first = (int) (pqRandom() % queue->sub_queue_count);
+        int second = (int) (pqRandom() % queue->sub_queue_count);
+        if (pqRelaxedPopFrom(queue, first, second, element)) {
+            return true;
+        }
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        if (pqRelaxedPopFrom(queue, i, i, element)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * pqBufferAbandon: Marks the insert buffer of a thread as abandoned once the thread exits, so the next flush of its
+ * queue frees it
+ * @param buffer
+ */
+static void pqBufferAbandon(void *buffer) {
+    pqBuffer abandoned = buffer;
+    pthread_mutex_lock(&abandoned->lock);
+    abandoned->abandoned = true;
+    pthread_mutex_unlock(&abandoned->lock);
+}
+
+/**
+ * pqFlushBuffer: Moves all the elements of an insert buffer into the queue as one batch, under a single lock of the
+ * queue. Called while holding the lock of the buffer
+ * @param queue
+ * @param buffer
+ * @return
+ *      PQ_OUT_OF_MEMORY if memory allocation failed, the elements stay in the buffer in that case
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqFlushBuffer(PriorityQueue queue, pqBuffer buffer) {
+    if (buffer->size == 0) {
+        return PQ_SUCCESS;
+    }
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqBatchInsert(queue, buffer->elements, buffer->priorities, buffer->size, true);
+    if (result == PQ_SUCCESS) {
+        queue->flushes = queue->flushes + 1;
+        queue->flushed = queue->flushed + buffer->size;
+        buffer->size = 0;
+    }
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqFlushBuffers: Flushes all the insert buffers of the queue, and frees the abandoned ones once they are empty
+ * @param queue
+ * @return
+ *      PQ_OUT_OF_MEMORY if memory allocation failed for one of the buffers
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqFlushBuffers(PriorityQueue queue) {
+    if (queue->buffer_size == 0) {
+        return PQ_SUCCESS;
+    }
+    PriorityQueueResult result = PQ_SUCCESS;
+    pthread_mutex_lock(&queue->buffers_lock);
+    pqBuffer *link = &queue->buffers;
+    while (*link != NULL) {
+        pqBuffer buffer = *link;
+        pthread_mutex_lock(&buffer->lock);
+        if (pqFlushBuffer(queue, buffer) != PQ_SUCCESS) {
+            result = PQ_OUT_OF_MEMORY;
+        }
+        bool release = buffer->abandoned && buffer->size == 0;
+        pthread_mutex_unlock(&buffer->lock);
+        if (release) {
+            *link = buffer->next;
+            pqBufferDestroy(buffer, queue->freeElement, queue->freePriority);
+        } else {
+            link = &buffer->next;
+        }
+    }
+    pthread_mutex_unlock(&queue->buffers_lock);
+    return result;
+}
+
+/**
+ * pqFlushBeforeRead: Flushes the insert buffers of a queue whose flush policy is PQ_FLUSH_ON_READ, called by every
+ * function other than the inserts before it takes the lock of the queue
+ * @param queue
+ */
+inline static void pqFlushBeforeRead(PriorityQueue queue) {
+    if (queue->buffer_size > 0 && queue->flush_policy == PQ_FLUSH_ON_READ) {
+        pqFlushBuffers(queue);
+    }
+}
+
+/**
+ * pqThreadBuffer: Retrieve the insert buffer of the calling thread, creating it on the first insert of the thread
+ * @param queue
+ * @return
+ *      NULL if memory allocation failed
+ *      the buffer of the thread otherwise
+ */
+static pqBuffer pqThreadBuffer(PriorityQueue queue) {
+    pqBuffer buffer = pthread_getspecific(queue->buffer_key);
+    if (buffer != NULL) {
+        return buffer;
+    }
+    buffer = pqBufferCreate(queue->buffer_size);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    if (pthread_setspecific(queue->buffer_key, buffer) != 0) {
+        pqBufferDestroy(buffer, queue->freeElement, queue->freePriority);
+        return NULL;
+    }
+    pthread_mutex_lock(&queue->buffers_lock);
+    buffer->next = queue->buffers;
+    queue->buffers = buffer;
+    pthread_mutex_unlock(&queue->buffers_lock);
+    return buffer;
+}
+
+/**
+ * pqBufferedInsert: Appends an element with its priority to the insert buffer of the calling thread, taking both,
+ * and flushes the buffer once it is full
+ * @param queue
+ * @param element
+ * @param priority
+ * @return
+ *      PQ_OUT_OF_MEMORY if memory allocation failed, the element and priority are left to the caller in that case
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqBufferedInsert(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    pqBuffer buffer = pqThreadBuffer(queue);
+    if (buffer == NULL) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    pthread_mutex_lock(&buffer->lock);
+    if (pqBufferIsFull(buffer) && pqFlushBuffer(queue, buffer) != PQ_SUCCESS) {
+        pthread_mutex_unlock(&buffer->lock);
+        return PQ_OUT_OF_MEMORY;
+    }
+    if (pqBufferAppend(buffer, element, priority)) {
+        pqFlushBuffer(queue, buffer);
+    }
+    pthread_mutex_unlock(&buffer->lock);
+    return PQ_SUCCESS;
+}
+
+/**
+ * pqBufferedInsertCopies: Appends copies of an element and its priority to the insert buffer of the calling thread
+ * @param queue
+ * @param element
+ * @param priority
+ * @return
+ *      PQ_OUT_OF_MEMORY if memory allocation or one of the copies failed
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqBufferedInsertCopies(PriorityQueue queue, PQElement element,
+                                                  PQElementPriority priority) {
+    PQ_COUNT_INTO(&queue->counters, copy_calls, 1);
+    PQElement element_copy = queue->copyElement(element);
+    if (element_copy != NULL) {
+        PQ_COUNT_INTO(&queue->counters, copy_calls, 1);
+    }
+    PQElementPriority priority_copy = element_copy == NULL ? NULL : queue->copyPriority(priority);
+    if (priority_copy == NULL || pqBufferedInsert(queue, element_copy, priority_copy) != PQ_SUCCESS) {
+        if (element_copy != NULL) {
+            PQ_COUNT_INTO(&queue->counters, free_calls, 1);
+            queue->freeElement(element_copy);
+        }
+        if (priority_copy != NULL) {
+            PQ_COUNT_INTO(&queue->counters, free_calls, 1);
+            queue->freePriority(priority_copy);
+        }
+        return PQ_OUT_OF_MEMORY;
+    }
+    return PQ_SUCCESS;
+}
+
+
+/*
+ * PROVIDED FUNCTIONS FOR PriorityQueue
+ */
+
+PriorityQueue pqCreate(CopyPQElement copy_element,
+                       FreePQElement free_element,
+                       EqualPQElements equal_elements,
+                       CopyPQElementPriority copy_priority,
+                       FreePQElementPriority free_priority,
+                       ComparePQElementPriorities compare_priorities) {
+    return pqCreateWithBackend(PQ_BACKEND_LIST, copy_element, free_element, equal_elements,
+                               copy_priority, free_priority, compare_priorities);
+}
+
+PriorityQueue pqCreateWithBackend(PQBackend backend,
+                                  CopyPQElement copy_element,
+                                  FreePQElement free_element,
+                                  EqualPQElements equal_elements,
+                                  CopyPQElementPriority copy_priority,
+                                  FreePQElementPriority free_priority,
+                                  ComparePQElementPriorities compare_priorities) {
+    if (pqCreateArgumentsValid(backend, copy_element, free_element, equal_elements,
+                               copy_priority, free_priority, compare_priorities) == false) {
+        return NULL;
+    }
+    return pqCreateFull(backend, copy_element, free_element, equal_elements,
+                        copy_priority, free_priority, compare_priorities, NULL);
+}
+
+PriorityQueue pqCreateIndexed(PQBackend backend,
+                              CopyPQElement copy_element,
+                              FreePQElement free_element,
+                              EqualPQElements equal_elements,
+                              CopyPQElementPriority copy_priority,
+                              FreePQElementPriority free_priority,
+                              ComparePQElementPriorities compare_priorities,
+                              HashPQElement hash_element) {
+    if (hash_element == NULL || pqCreateArgumentsValid(backend, copy_element, free_element, equal_elements,
+                                                       copy_priority, free_priority, compare_priorities) == false) {
+        return NULL;
+    }
+    return pqCreateFull(backend, copy_element, free_element, equal_elements,
+                        copy_priority, free_priority, compare_priorities, hash_element);
+}
+
+PriorityQueue pqCreateScalar(PQBackend backend,
+                             CopyPQElement copy_element,
+                             FreePQElement free_element,
+                             EqualPQElements equal_elements,
+                             HashPQElement hash_element) {
+    if (copy_element == NULL || free_element == NULL || equal_elements == NULL ||
+        (backend != PQ_BACKEND_LIST && backend != PQ_BACKEND_HEAP && backend != PQ_BACKEND_ARRAY &&
+         backend != PQ_BACKEND_RADIX && backend != PQ_BACKEND_WHEEL)) {
+        return NULL;
+    }
+    return pqCreateFull(backend, copy_element, free_element, equal_elements, NULL, NULL, NULL, hash_element);
+}
+
+PriorityQueue pqCreateFromArray(PQBackend backend,
+                                CopyPQElement copy_element,
+                                FreePQElement free_element,
+                                EqualPQElements equal_elements,
+                                CopyPQElementPriority copy_priority,
+                                FreePQElementPriority free_priority,
+                                ComparePQElementPriorities compare_priorities,
+                                PQElement *elements,
+                                PQElementPriority *priorities,
+                                int count) {
+    PriorityQueue queue = pqCreateWithBackend(backend, copy_element, free_element, equal_elements,
+                                              copy_priority, free_priority, compare_priorities);
+    if (queue == NULL) {
+        return NULL;
+    }
+    if (pqInsertBatch(queue, elements, priorities, count) != PQ_SUCCESS) {
+        pqDestroy(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+PriorityQueue pqCreateConcurrent(PQBackend backend,
+                                 CopyPQElement copy_element,
+                                 FreePQElement free_element,
+                                 EqualPQElements equal_elements,
+                                 CopyPQElementPriority copy_priority,
+                                 FreePQElementPriority free_priority,
+                                 ComparePQElementPriorities compare_priorities) {
+    PriorityQueue queue = pqCreateWithBackend(backend, copy_element, free_element, equal_elements,
+                                              copy_priority, free_priority, compare_priorities);
+    if (queue == NULL) {
+        return NULL;
+    }
+    if (pthread_rwlock_init(&queue->lock, NULL) != 0) {
+        pqDestroy(queue);
+        return NULL;
+    }
+    if (pthread_mutex_init(&queue->nodes_lock, NULL) != 0) {
+        pthread_rwlock_destroy(&queue->lock);
+        pqDestroy(queue);
+        return NULL;
+    }
+    queue->concurrent = true;
+    if (pqFineGrained(queue) && pqHeapMakeConcurrent(queue->entries->heap) == false) {
+        pqDestroy(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+PriorityQueue pqCreateRelaxed(int threads,
+                              int sub_queues_per_thread,
+                              CopyPQElement copy_element,
+                              FreePQElement free_element,
+                              EqualPQElements equal_elements,
+                              CopyPQElementPriority copy_priority,
+                              FreePQElementPriority free_priority,
+                              ComparePQElementPriorities compare_priorities) {
+    if (threads <= 0 || sub_queues_per_thread <= 0) {
+        return NULL;
+    }
+    PriorityQueue queue = pqCreateWithBackend(PQ_BACKEND_HEAP, copy_element, free_element, equal_elements,
+                                              copy_priority, free_priority, compare_priorities);
+    if (queue == NULL) {
+        return NULL;
+    }
+    int count = threads * sub_queues_per_thread;
+    queue->sub_queues = malloc(sizeof(*queue->sub_queues) * count);
+    if (queue->sub_queues == NULL) {
+        pqDestroy(queue);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        queue->sub_queues[i] = pqCreateConcurrent(PQ_BACKEND_HEAP, copy_element, free_element, equal_elements,
+                                                  copy_priority, free_priority, compare_priorities);
+        if (queue->sub_queues[i] == NULL) {
+            pqDestroy(queue);
+            return NULL;
+        }
+        queue->sub_queue_count = i + 1;
+    }
+    return queue;
+}
+
+PriorityQueue pqCreateBuffered(PQBackend backend,
+                               PQFlushPolicy flush_policy,
+                               int buffer_size,
+                               CopyPQElement copy_element,
+                               FreePQElement free_element,
+                               EqualPQElements equal_elements,
+                               CopyPQElementPriority copy_priority,
+                               FreePQElementPriority free_priority,
+                               ComparePQElementPriorities compare_priorities) {
+    if (buffer_size <= 0 || (flush_policy != PQ_FLUSH_ON_READ && flush_policy != PQ_FLUSH_WHEN_FULL)) {
+        return NULL;
+    }
+    PriorityQueue queue = pqCreateConcurrent(backend, copy_element, free_element, equal_elements,
+                                             copy_priority, free_priority, compare_priorities);
+    if (queue == NULL) {
+        return NULL;
+    }
+    if (pthread_key_create(&queue->buffer_key, pqBufferAbandon) != 0) {
+        pqDestroy(queue);
+        return NULL;
+    }
+    if (pthread_mutex_init(&queue->buffers_lock, NULL) != 0) {
+        pthread_key_delete(queue->buffer_key);
+        pqDestroy(queue);
+        return NULL;
+    }
+    queue->flush_policy = flush_policy;
+    queue->buffer_size = buffer_size;
+    return queue;
+}
+
+/**
+ * pqSkipFree: The free function of the elements and priorities of a bounded queue, which are kept in its storage
+ * @param value
+ */
+static void pqSkipFree(void *value) {
+    (void) value;
+}
+
+PriorityQueue pqCreateBounded(PQBackend backend,
+                              int capacity,
+                              size_t element_size,
+                              size_t priority_size,
+                              EqualPQElements equal_elements,
+                              ComparePQElementPriorities compare_priorities) {
+    if (capacity <= 0 || element_size == 0 || priority_size == 0 || equal_elements == NULL ||
+        compare_priorities == NULL || (backend != PQ_BACKEND_LIST && backend != PQ_BACKEND_HEAP)) {
+        return NULL;
+    }
+    PriorityQueue queue = pqCreateFull(backend, NULL, pqSkipFree, equal_elements, NULL, pqSkipFree,
+                                       compare_priorities, NULL);
+    if (queue == NULL) {
+        return NULL;
+    }
+    size_t alignment = sizeof(pqSlotAlignment);
+    queue->capacity = capacity;
+    queue->element_size = element_size;
+    queue->priority_size = priority_size;
+    queue->priority_offset = (element_size + alignment - 1) / alignment * alignment;
+    queue->slot_size = queue->priority_offset + (priority_size + alignment - 1) / alignment * alignment;
+    queue->trivialDestruction = true;
+    if (pqEntriesReserve(queue, queue->entries) == false) {
+        pqDestroy(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+void pqDestroy(PriorityQueue queue) {
+    if (queue == NULL) {
+        return;
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        pqDestroy(queue->sub_queues[i]);
+    }
+    free(queue->sub_queues);
+    if (queue->buffer_size > 0) {
+        pthread_key_delete(queue->buffer_key);
+        while (queue->buffers != NULL) {
+            pqBuffer next = queue->buffers->next;
+            pqBufferDestroy(queue->buffers, queue->freeElement, queue->freePriority);
+            queue->buffers = next;
+        }
+        pthread_mutex_destroy(&queue->buffers_lock);
+    }
+    pqIteratorReset(&queue->iterator);
+    pqEntriesRelease(queue);
+    if (queue->concurrent) {
+        pthread_rwlock_destroy(&queue->lock);
+        pthread_mutex_destroy(&queue->nodes_lock);
+    }
+    free(queue);
+}
+
+/**
+ * pqCopyLocked: pqCopy, called while holding the lock of the queue
+ */
+static PriorityQueue pqCopyLocked(PriorityQueue queue) {
+    if (queue == NULL) {
+        return NULL;
+    }
+    PriorityQueue new_queue = malloc(sizeof(*new_queue));
+    if (new_queue == NULL) {
+        return NULL;
+    }
+    *new_queue = *queue;
+    new_queue->buffer_size = 0;
+    new_queue->buffers = NULL;
+    new_queue->flushes = 0;
+    new_queue->flushed = 0;
+    new_queue->compactions = 0;
+    new_queue->compaction_seconds = 0;
+    pqIteratorInit(&new_queue->iterator, new_queue);
+    pqIteratorReset(&queue->iterator);
+    if (queue->concurrent == false && queue->capacity == 0) {
+        queue->entries->refs = queue->entries->refs + 1;
+        pqStatsReset(new_queue);
+        return new_queue;
+    }
+    new_queue->entries = pqEntriesCopy(queue);
+    if (new_queue->entries == NULL) {
+        free(new_queue);
+        return NULL;
+    }
+    new_queue->entries->owner = new_queue;
+    if (new_queue->concurrent && pthread_rwlock_init(&new_queue->lock, NULL) != 0) {
+        pqEntriesDestroy(new_queue, new_queue->entries);
+        free(new_queue);
+        return NULL;
+    }
+    if (new_queue->concurrent && pthread_mutex_init(&new_queue->nodes_lock, NULL) != 0) {
+        pthread_rwlock_destroy(&new_queue->lock);
+        pqEntriesDestroy(new_queue, new_queue->entries);
+        free(new_queue);
+        return NULL;
+    }
+    pqStatsReset(new_queue);
+    return new_queue;
+}
+
+PriorityQueue pqCopy(PriorityQueue queue) {
+    if (queue == NULL) {
+        return NULL;
+    }
+    if (queue->sub_queues != NULL) {
+        return NULL;
+    }
+    pqFlushBeforeRead(queue);
+    pqLockWrite(queue);
+    PriorityQueue new_queue = pqCopyLocked(queue);
+    pqUnlock(queue);
+    return new_queue;
+}
+
+int pqGetSize(PriorityQueue queue) {
+    if (queue == NULL) {
+        return ELEMENT_NOT_FOUND;
+    }
+    pqFlushBeforeRead(queue);
+    int size = 0;
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        size = size + pqGetSize(queue->sub_queues[i]);
+    }
+    pqLockShared(queue);
+    size = size + __atomic_load_n(&queue->entries->size, __ATOMIC_RELAXED) - queue->entries->dead;
+    pqUnlock(queue);
+    return size;
+}
+
+bool pqContains(PriorityQueue queue, PQElement element) {
+    if (queue == NULL || element == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        if (pqContains(queue->sub_queues[i], element)) {
+            return true;
+        }
+    }
+    pqFlushBeforeRead(queue);
+    pqLockRead(queue);
+    bool found = pqFindNode(queue, element, NULL) != NULL;
+    pqUnlock(queue);
+    return found;
+}
+
+PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    return pqInsertWithHandle(queue, element, priority, NULL);
+}
+
+/**
+ * pqInsertWithHandleLocked: pqInsertWithHandle, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqInsertWithHandleLocked(PriorityQueue queue, PQElement element,
+                                                     PQElementPriority priority, PQHandle *handle) {
+    if (queue == NULL || element == NULL || priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->capacity > 0 && queue->entries->size == queue->capacity) {
+        return PQ_FULL;
+    }
+    if (pqDetach(queue) != PQ_SUCCESS) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    pqNode new_node = pqNodeCreate(queue->entries->pool, NULL, NULL, NULL);
+    setIteratorToNULL(queue);
+    if (new_node == NULL) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    if (pqNodeSetElement(queue, new_node, element) == false ||
+        pqNodeSetPriority(queue, new_node, priority) == false ||
+        pqLinkNewNode(queue, new_node, handle) != PQ_SUCCESS) {
+        pqNodeFree(queue->entries->pool, new_node, queue->freeElement, queue->freePriority);
+        return PQ_OUT_OF_MEMORY;
+    }
+    return PQ_SUCCESS;
+}
+
+/**
+ * pqInsertShared: Inserts an element into a queue with fine-grained locking under its shared lock, while other
+ * threads insert and pop. The node is created and given its element and priority before it claims a position of the
+ * heap, so the user's copy functions run without any lock of the queue but the shared one. A heap without room is
+ * grown under the lock for writing, and the insert tried again
+ * @param queue
+ * @param element
+ * @param priority
+ * @param handle - receives the handle of the node if not NULL
+ * @param take - whether the node takes element and priority as they are, as in pqInsertTake, instead of copies
+ * @return
+ *      PQ_ERROR if the queue can't be modified under its shared lock, see pqSharedPathOpen, it is unchanged then
+ *      PQ_NULL_ARGUMENT if element or priority are NULL
+ *      PQ_OUT_OF_MEMORY if memory allocation or one of the copies failed
+ *      PQ_SUCCESS otherwise
+ */
+static PriorityQueueResult pqInsertShared(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                          PQHandle *handle, bool take) {
+    if (element == NULL || priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    pqLockShared(queue);
+    while (pqSharedPathOpen(queue) && pqHeapConcurrentClaim(queue->entries->heap) == false) {
+        pqUnlock(queue);
+        pqLockWrite(queue);
+        bool grown = pqHeapReserve(queue->entries->heap, pqHeapGetSize(queue->entries->heap) + 1);
+        pqUnlock(queue);
+        if (grown == false) {
+            return PQ_OUT_OF_MEMORY;
+        }
+        pqLockShared(queue);
+    }
+    if (pqSharedPathOpen(queue) == false) {
+        pqUnlock(queue);
+        return PQ_ERROR;
+    }
+    pqEntries entries = queue->entries;
+    pthread_mutex_lock(&queue->nodes_lock);
+    pqNode new_node = pqNodeCreate(entries->pool, take ? element : NULL, NULL, NULL);
+    setIteratorToNULL(queue);
+    pthread_mutex_unlock(&queue->nodes_lock);
+    if (new_node != NULL && take) {
+        pqNodeTakePriority(queue, new_node, priority);
+    } else if (new_node != NULL && (pqNodeSetElement(queue, new_node, element) == false ||
+                                    pqNodeSetPriority(queue, new_node, priority) == false)) {
+        pthread_mutex_lock(&queue->nodes_lock);
+        pqNodeFree(entries->pool, new_node, queue->freeElement, queue->freePriority);
+        pthread_mutex_unlock(&queue->nodes_lock);
+        new_node = NULL;
+    }
+    if (new_node == NULL) {
+        pqHeapConcurrentUnclaim(entries->heap);
+        pqUnlock(queue);
+        return PQ_OUT_OF_MEMORY;
+    }
+    PQ_COUNT(inserts, 1);
+    new_node->sequence = __atomic_fetch_add(&entries->next_sequence, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&entries->size, 1, __ATOMIC_RELAXED);
+    pqHeapConcurrentPush(entries->heap, new_node);
+    pqStatsNoteSize(queue);
+    if (handle != NULL) {
+        *handle = (PQHandle) new_node;
+    }
+    pqUnlock(queue);
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqInsertWithHandle(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                       PQHandle *handle) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->sub_queues != NULL) {
+        return handle != NULL ? PQ_ERROR : pqInsertWithHandle(pqRelaxedPick(queue), element, priority, NULL);
+    }
+    if (queue->buffer_size > 0 && handle == NULL) {
+        if (element == NULL || priority == NULL) {
+            return PQ_NULL_ARGUMENT;
+        }
+        return pqBufferedInsertCopies(queue, element, priority);
+    }
+    if (pqFineGrained(queue)) {
+        PriorityQueueResult result = pqInsertShared(queue, element, priority, handle, false);
+        if (result != PQ_ERROR) {
+            return result;
+        }
+    }
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqInsertWithHandleLocked(queue, element, priority, handle);
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqInsertTakeLocked: pqInsertTake, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqInsertTakeLocked(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    if (queue == NULL || element == NULL || priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (pqDetach(queue) != PQ_SUCCESS) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    pqNode new_node = pqNodeCreate(queue->entries->pool, element, NULL, NULL);
+    setIteratorToNULL(queue);
+    if (new_node == NULL) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    pqNodeTakePriority(queue, new_node, priority);
+    if (pqLinkNewNode(queue, new_node, NULL) != PQ_SUCCESS) {
+        new_node->element = NULL;
+        new_node->priority.pointer = NULL;
+        pqNodeFree(queue->entries->pool, new_node, queue->freeElement, queue->freePriority);
+        return PQ_OUT_OF_MEMORY;
+    }
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqInsertTake(PriorityQueue queue, PQElement element, PQElementPriority priority) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->sub_queues != NULL) {
+        return pqInsertTake(pqRelaxedPick(queue), element, priority);
+    }
+    if (queue->capacity > 0) {
+        return PQ_ERROR;
+    }
+    if (queue->buffer_size > 0) {
+        if (element == NULL || priority == NULL) {
+            return PQ_NULL_ARGUMENT;
+        }
+        return pqBufferedInsert(queue, element, priority);
+    }
+    if (pqFineGrained(queue)) {
+        PriorityQueueResult result = pqInsertShared(queue, element, priority, NULL, true);
+        if (result != PQ_ERROR) {
+            return result;
+        }
+    }
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqInsertTakeLocked(queue, element, priority);
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqInsertBatchLocked: pqInsertBatch, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqInsertBatchLocked(PriorityQueue queue, PQElement *elements,
+                                               PQElementPriority *priorities, int count) {
+    if (queue == NULL || (count > 0 && (elements == NULL || priorities == NULL))) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (count < 0) {
+        return PQ_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        if (elements[i] == NULL || priorities[i] == NULL) {
+            return PQ_NULL_ARGUMENT;
+        }
+    }
+    if (count == 0) {
+        setIteratorToNULL(queue);
+        return PQ_SUCCESS;
+    }
+    if (queue->capacity > 0) {
+        if (queue->entries->size + count > queue->capacity) {
+            return PQ_FULL;
+        }
+        for (int i = 0; i < count; i++) {
+            pqInsertWithHandleLocked(queue, elements[i], priorities[i], NULL);
+        }
+        return PQ_SUCCESS;
+    }
+    return pqBatchInsert(queue, elements, priorities, count, false);
+}
+
+PriorityQueueResult pqInsertBatch(PriorityQueue queue, PQElement *elements, PQElementPriority *priorities, int count) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->sub_queues != NULL) {
+        return pqInsertBatch(pqRelaxedPick(queue), elements, priorities, count);
+    }
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqInsertBatchLocked(queue, elements, priorities, count);
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqChangePriorityLocked: pqChangePriority, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqChangePriorityLocked(PriorityQueue queue, PQElement element,
+                                                  PQElementPriority old_priority, PQElementPriority new_priority) {
+    if (queue == NULL || element == NULL || old_priority == NULL || new_priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    PriorityQueueResult result;
+    pqNode node = pqFindNodeToModify(queue, element, old_priority, &result);
+    if (result != PQ_SUCCESS) {
+        return result;
+    }
+    if (node == NULL) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+    return pqNodeChangePriority(queue, node, new_priority);
+}
+
+PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element, PQElementPriority old_priority,
+                                     PQElementPriority new_priority) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        PriorityQueueResult result = pqChangePriority(queue->sub_queues[i], element, old_priority, new_priority);
+        if (result != PQ_ELEMENT_DOES_NOT_EXISTS) {
+            return result;
+        }
+    }
+    pqFlushBeforeRead(queue);
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqChangePriorityLocked(queue, element, old_priority, new_priority);
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqChangePriorityByHandleLocked: pqChangePriorityByHandle, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqChangePriorityByHandleLocked(PriorityQueue queue, PQHandle handle,
+                                                          PQElementPriority new_priority) {
+    if (queue == NULL || handle == NULL || new_priority == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (pqDetach(queue) != PQ_SUCCESS) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    return pqNodeChangePriority(queue, (pqNode) handle, new_priority);
+}
+
+PriorityQueueResult pqChangePriorityByHandle(PriorityQueue queue, PQHandle handle, PQElementPriority new_priority) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->sub_queues != NULL) {
+        return PQ_ERROR;
+    }
+    pqFlushBeforeRead(queue);
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqChangePriorityByHandleLocked(queue, handle, new_priority);
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqNodeMatches: Checks whether a node is one that pqRemoveIf or a compaction removes
+ * @param node
+ * @param predicate - the predicate given to pqRemoveIf, or NULL to match the tombstones
+ * @param context
+ * @return
+ *      true if the node should be removed
+ *      false otherwise
+ */
+static bool pqNodeMatches(pqNode node, MatchPQElement predicate, void *context) {
+    if (predicate == NULL) {
+        return node->dead;
+    }
+    return node->dead == false && predicate(pqNodeGetElement(node), context);
+}
+
+/**
+ * pqListRemoveIf: Removes the matching nodes of a list as it is walked
+ * @param queue
+ * @param predicate
+ * @param context
+ * @return
+ *      the amount of nodes removed
+ */
+static int pqListRemoveIf(PriorityQueue queue, MatchPQElement predicate, void *context) {
+    int count = 0;
+    pqNode node = queue->entries->first;
+    while (node != NULL) {
+        pqNode next = pqNodeGetNext(node);
+        if (pqNodeMatches(node, predicate, context)) {
+            pqRemoveNode(queue, node);
+            count = count + 1;
+        }
+        node = next;
+    }
+    return count;
+}
+
+/**
+ * pqRemoveMatching: Removes the matching nodes of a queue whose entries are not shared in one pass. Except for a
+ * list, the matching nodes are gathered before any of them is removed, since removing a node moves others inside the
+ * heap, the array or the buckets
+ * @param queue
+ * @param predicate - the predicate given to pqRemoveIf, or NULL to remove the tombstones
+ * @param context
+ * @return
+ *      -1 if memory allocation failed, the queue is unchanged in that case
+ *      the amount of nodes removed otherwise
+ */
+static int pqRemoveMatching(PriorityQueue queue, MatchPQElement predicate, void *context) {
+    if (queue->backend == PQ_BACKEND_LIST) {
+        return pqListRemoveIf(queue, predicate, context);
+    }
+    int size = queue->entries->size;
+    if (size == 0) {
+        return 0;
+    }
+    pqNode *nodes = pqEntriesGetNodes(queue);
+    if (nodes == NULL) {
+        return ELEMENT_NOT_FOUND;
+    }
+    int count = 0;
+    for (int i = 0; i < size; i++) {
+        if (pqNodeMatches(nodes[i], predicate, context)) {
+            nodes[count] = nodes[i];
+            count = count + 1;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        pqRemoveNode(queue, nodes[i]);
+    }
+    free(nodes);
+    return count;
+}
+
+/**
+ * pqCompact: Removes all the tombstones of a queue whose entries are not shared, and adds the time it took to the
+ * statistics of the queue
+ * @param queue
+ * @return
+ *      false if memory allocation failed, the tombstones are kept in that case
+ *      true otherwise
+ */
+static bool pqCompact(PriorityQueue queue) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (pqRemoveMatching(queue, NULL, NULL) < 0) {
+        return false;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    queue->compactions = queue->compactions + 1;
+    queue->compaction_seconds = queue->compaction_seconds + (double) (end.tv_sec - start.tv_sec) +
+                                (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+    return true;
+}
+
+/**
+ * pqBuryNode: Turns a node of a queue in lazy deletion mode into a tombstone: its element is freed and it leaves the
+ * index, but it stays where it is in the list, the heap, the array or the buckets. Once the tombstones are more than
+ * the compaction fraction of the nodes, they are all compacted away. If that fails, they are left for the next time
+ * @param queue
+ * @param node
+ */
+static void pqBuryNode(PriorityQueue queue, pqNode node) {
+    setIteratorToNULL(queue);
+    pqIndexRemove(queue->entries->index, node);
+    PQ_COUNT(free_calls, 1);
+    queue->freeElement(node->element);
+    node->element = NULL;
+    node->dead = true;
+    queue->entries->dead = queue->entries->dead + 1;
+    if (queue->entries->dead > queue->compaction_fraction * queue->entries->size) {
+        pqCompact(queue);
+    }
+}
+
+/**
+ * pqRemoveLocked: pqRemove, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqRemoveLocked(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
     if (isPQEmpty(queue) == true) {
         return PQ_SUCCESS;
     }
-    pqNode temp = pqNodeGetNext(queue->first);
-    pqNodeFree(queue->first);
-    queue->first = temp;
-    setIteratorToNULL(queue);
-    return pqUpdateSizeAfterRemoveAndReturnSuccess(queue);
+    if (pqDetach(queue) != PQ_SUCCESS) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    return pqRemoveNode(queue, pqFirstLiveNode(queue));
 }
 
-PriorityQueueResult pqRemoveElement(PriorityQueue queue, PQElement element) {
+PriorityQueueResult pqRemove(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->sub_queues != NULL) {
+        PQElement element;
+        if (pqRelaxedPop(queue, &element)) {
+            PQ_COUNT_INTO(&queue->counters, free_calls, 1);
+            queue->freeElement(element);
+        }
+        return PQ_SUCCESS;
+    }
+    pqFlushBeforeRead(queue);
+    if (pqFineGrained(queue) && pqPopShared(queue, 1, NULL) >= 0) {
+        return PQ_SUCCESS;
+    }
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqRemoveLocked(queue);
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqRemoveElementLocked: pqRemoveElement, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqRemoveElementLocked(PriorityQueue queue, PQElement element) {
     if (queue == NULL || element == NULL) {
         return PQ_NULL_ARGUMENT;
     }
-    setIteratorToNULL(queue);
-    if (pqContains(queue, element) == true) {
-        PriorityQueueResult result = pqRemoveElementAndPriority(queue, element, NULL);
+    PriorityQueueResult result;
+    pqNode node = pqFindNodeToModify(queue, element, NULL, &result);
+    if (result != PQ_SUCCESS) {
         return result;
     }
-    return PQ_ELEMENT_DOES_NOT_EXISTS;
+    if (node == NULL) {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+    setIteratorToNULL(queue);
+    if (queue->compaction_fraction > 0) {
+        pqBuryNode(queue, node);
+        return PQ_SUCCESS;
+    }
+    return pqRemoveNode(queue, node);
+}
+
+PriorityQueueResult pqRemoveElement(PriorityQueue queue, PQElement element) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        PriorityQueueResult result = pqRemoveElement(queue->sub_queues[i], element);
+        if (result != PQ_ELEMENT_DOES_NOT_EXISTS) {
+            return result;
+        }
+    }
+    pqFlushBeforeRead(queue);
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqRemoveElementLocked(queue, element);
+    pqUnlock(queue);
+    return result;
+}
+
+/**
+ * pqRemoveIfLocked: pqRemoveIf, called while holding the lock of the queue
+ */
+static int pqRemoveIfLocked(PriorityQueue queue, MatchPQElement predicate, void *context) {
+    if (queue == NULL || predicate == NULL) {
+        return ELEMENT_NOT_FOUND;
+    }
+    if (isPQEmpty(queue) == true) {
+        return 0;
+    }
+    if (pqDetach(queue) != PQ_SUCCESS) {
+        return ELEMENT_NOT_FOUND;
+    }
+    return pqRemoveMatching(queue, predicate, context);
+}
+
+int pqRemoveIf(PriorityQueue queue, MatchPQElement predicate, void *context) {
+    if (queue == NULL) {
+        return ELEMENT_NOT_FOUND;
+    }
+    int removed = 0;
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        int count = pqRemoveIf(queue->sub_queues[i], predicate, context);
+        if (count < 0) {
+            return ELEMENT_NOT_FOUND;
+        }
+        removed = removed + count;
+    }
+    if (queue->sub_queues != NULL) {
+        return removed;
+    }
+    pqFlushBeforeRead(queue);
+    pqLockWrite(queue);
+    int count = pqRemoveIfLocked(queue, predicate, context);
+    pqUnlock(queue);
+    return count;
+}
+
+/**
+ * pqPeekTopKLocked: pqPeekTopK, called while holding the lock of the queue
+ */
+static int pqPeekTopKLocked(PriorityQueue queue, int k, PQElement *out_elements) {
+    if (queue == NULL || out_elements == NULL || k < 0) {
+        return ELEMENT_NOT_FOUND;
+    }
+    if (k > queue->entries->size - queue->entries->dead) {
+        k = queue->entries->size - queue->entries->dead;
+    }
+    if (k == 0) {
+        return 0;
+    }
+    if (queue->backend != PQ_BACKEND_LIST) {
+        int wanted = k + queue->entries->dead;
+        pqNode *nodes = malloc(sizeof(*nodes) * wanted);
+        PQ_COUNT_ALLOCATION(nodes, sizeof(*nodes) * wanted);
+        if (nodes == NULL) {
+            return ELEMENT_NOT_FOUND;
+        }
+        int found;
+        if (queue->backend == PQ_BACKEND_HEAP) {
+            found = pqHeapTopK(queue->entries->heap, wanted, nodes);
+        } else if (queue->backend == PQ_BACKEND_ARRAY) {
+            found = pqArrayTopK(queue->entries->array, wanted, nodes);
+        } else if (queue->backend == PQ_BACKEND_RADIX) {
+            found = pqRadixTopK(queue->entries->radix, wanted, nodes);
+        } else {
+            found = pqWheelTopK(queue->entries->wheel, wanted, nodes);
+        }
+        int count = 0;
+        for (int i = 0; i < found && count < k; i++) {
+            if (nodes[i]->dead == false) {
+                out_elements[count] = pqNodeGetElement(nodes[i]);
+                count = count + 1;
+            }
+        }
+        free(nodes);
+        return found < 0 ? ELEMENT_NOT_FOUND : count;
+    }
+    int count = 0;
+    for (pqNode node = pqListSkipDead(queue->entries->first); node != NULL && count < k;
+         node = pqListSkipDead(pqNodeGetNext(node))) {
+        out_elements[count] = pqNodeGetElement(node);
+        count = count + 1;
+    }
+    return count;
+}
+
+int pqPeekTopK(PriorityQueue queue, int k, PQElement *out_elements) {
+    if (queue == NULL) {
+        return ELEMENT_NOT_FOUND;
+    }
+    if (queue->sub_queues != NULL) {
+        return ELEMENT_NOT_FOUND;
+    }
+    pqFlushBeforeRead(queue);
+    pqLockWalk(queue);
+    int count = pqPeekTopKLocked(queue, k, out_elements);
+    pqUnlock(queue);
+    return count;
+}
+
+int pqPopMany(PriorityQueue queue, int k, PQElement *out_elements) {
+    if (queue == NULL) {
+        return ELEMENT_NOT_FOUND;
+    }
+    if (queue->sub_queues != NULL) {
+        if (out_elements == NULL || k < 0) {
+            return ELEMENT_NOT_FOUND;
+        }
+        int count = 0;
+        while (count < k && pqRelaxedPop(queue, &out_elements[count])) {
+            count = count + 1;
+        }
+        return count;
+    }
+    if (queue->capacity > 0) {
+        return ELEMENT_NOT_FOUND;
+    }
+    pqFlushBeforeRead(queue);
+    if (pqFineGrained(queue) && out_elements != NULL && k >= 0) {
+        int count = pqPopShared(queue, k, out_elements);
+        if (count >= 0) {
+            return count;
+        }
+    }
+    pqLockWrite(queue);
+    int count = pqPopManyLocked(queue, k, out_elements);
+    pqUnlock(queue);
+    return count;
+}
+
+/**
+ * pqMergeLocked: pqMerge, called while holding the locks of both queues
+ */
+static PriorityQueueResult pqMergeLocked(PriorityQueue destination, PriorityQueue source) {
+    if (destination == NULL || source == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (pqMergeArgumentsValid(destination, source) == false) {
+        return PQ_ERROR;
+    }
+    if (isPQEmpty(source) == true) {
+        return PQ_SUCCESS;
+    }
+    if (pqDetach(destination) != PQ_SUCCESS || pqDetach(source) != PQ_SUCCESS) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    if (source->entries->dead > 0 && pqCompact(source) == false) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    pqEntries empty = pqEntriesCreate(source);
+    pqNode *nodes = pqEntriesGetNodes(source);
+    if (empty == NULL || nodes == NULL) {
+        free(nodes);
+        if (empty != NULL) {
+            pqEntriesDestroy(source, empty);
+        }
+        return PQ_OUT_OF_MEMORY;
+    }
+    pqEntries entries = source->entries;
+    for (int i = 0; i < entries->size; i++) {
+        nodes[i]->sequence = nodes[i]->sequence + destination->entries->next_sequence;
+    }
+    if (pqMergeNodes(destination, source, nodes) == false) {
+        for (int i = 0; i < entries->size; i++) {
+            nodes[i]->sequence = nodes[i]->sequence - destination->entries->next_sequence;
+        }
+        free(nodes);
+        pqEntriesDestroy(source, empty);
+        return PQ_OUT_OF_MEMORY;
+    }
+    setIteratorToNULL(destination);
+    for (int i = 0; i < entries->size; i++) {
+        pqIndexAdd(destination->entries->index, nodes[i]);
+    }
+    free(nodes);
+    destination->entries->next_sequence = destination->entries->next_sequence + entries->next_sequence;
+    pqNodePoolAdopt(destination->entries->pool, entries->pool);
+    pqHeapDestroy(entries->heap);
+    pqArrayDestroy(entries->array);
+    pqRadixDestroy(entries->radix);
+    pqWheelDestroy(entries->wheel);
+    pqIndexDestroy(entries->index);
+    pqNodePoolDestroy(entries->pool);
+    empty->version = entries->version + 1;
+    free(entries);
+    pqIteratorReset(&source->iterator);
+    source->entries = empty;
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqMerge(PriorityQueue destination, PriorityQueue source) {
+    if (destination == NULL || source == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (destination == source || destination->sub_queues != NULL || source->sub_queues != NULL ||
+        destination->capacity > 0 || source->capacity > 0) {
+        return PQ_ERROR;
+    }
+    pqFlushBeforeRead(destination);
+    pqFlushBeforeRead(source);
+    bool destination_first = (uintptr_t) destination < (uintptr_t) source;
+    PriorityQueue first_locked = destination_first ? destination : source;
+    PriorityQueue second_locked = destination_first ? source : destination;
+    pqStatsBegin(destination);
+    pqLockWrite(first_locked);
+    pqLockWrite(second_locked);
+    PriorityQueueResult result = pqMergeLocked(destination, source);
+    if (result == PQ_SUCCESS) {
+        pqStatsNoteSize(destination);
+    }
+    pqUnlock(second_locked);
+    pqUnlock(first_locked);
+    pqStatsEnd(destination);
+    return result;
 }
 
 PQElement pqGetFirst(PriorityQueue queue) {
     if (queue == NULL) {
         return NULL;
     }
-    if (queue->first == NULL) {
+    if (queue->sub_queues != NULL) {
         return NULL;
     }
-    queue->iterator = 1;
-    queue->iteratorP = queue->first;
-    return pqNodeGetElement(queue->first);
+    pqFlushBeforeRead(queue);
+    pqLockWrite(queue);
+    PQElement element = pqIteratorStart(&queue->iterator);
+    pqUnlock(queue);
+    return element;
 }
 
 PQElement pqGetNext(PriorityQueue queue) {
     if (queue == NULL) {
         return NULL;
     }
-    if (queue->iteratorP == NULL) {
+    if (queue->sub_queues != NULL) {
+        return NULL;
+    }
+    pqLockWrite(queue);
+    PQElement element = pqIteratorAdvance(&queue->iterator);
+    pqUnlock(queue);
+    return element;
+}
+
+PQIterator pqIteratorCreate(PriorityQueue queue) {
+    if (queue == NULL) {
+        return NULL;
+    }
+    if (queue->sub_queues != NULL) {
+        return NULL;
+    }
+    PQIterator iterator = malloc(sizeof(*iterator));
+    if (iterator == NULL) {
+        return NULL;
+    }
+    pqLockRead(queue);
+    pqIteratorInit(iterator, queue);
+    pqUnlock(queue);
+    return iterator;
+}
+
+void pqIteratorDestroy(PQIterator iterator) {
+    if (iterator == NULL) {
+        return;
+    }
+    pqIteratorReset(iterator);
+    free(iterator);
+}
+
+PQElement pqIteratorFirst(PQIterator iterator) {
+    if (iterator == NULL) {
         return NULL;
     }
-    if (queue->first->next == NULL) {
+    pqFlushBeforeRead(iterator->queue);
+    pqLockWalk(iterator->queue);
+    PQElement element = pqIteratorStart(iterator);
+    pqUnlock(iterator->queue);
+    return element;
+}
+
+PQElement pqIteratorNext(PQIterator iterator) {
+    if (iterator == NULL) {
         return NULL;
     }
-    queue->iterator = queue->iterator + 1;
-    queue->iteratorP = queue->first->next;
-    return pqNodeGetElement((pqNodeIterate(queue->first, queue->iterator)));
+    pqLockWalk(iterator->queue);
+    PQElement element = pqIteratorAdvance(iterator);
+    pqUnlock(iterator->queue);
+    return element;
+}
+
+/**
+ * pqClearLocked: pqClear, called while holding the lock of the queue
+ */
+static PriorityQueueResult pqClearLocked(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    pqEntries entries = queue->capacity > 0 ? NULL : pqEntriesCreate(queue);
+    if (entries == NULL && queue->entries->refs > 1) {
+        return PQ_OUT_OF_MEMORY;
+    }
+    if (entries == NULL) {
+        while (isPQEmpty(queue) == false) {
+            pqRemoveLocked(queue);
+        }
+        return PQ_SUCCESS;
+    }
+    entries->version = queue->entries->version + 1;
+    pqIteratorReset(&queue->iterator);
+    pqEntriesRelease(queue);
+    queue->entries = entries;
+    return PQ_SUCCESS;
 }
 
 PriorityQueueResult pqClear(PriorityQueue queue) {
     if (queue == NULL) {
         return PQ_NULL_ARGUMENT;
     }
-    while (pqGetSize(queue) != 0) {
-        pqRemove(queue);
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        pqClear(queue->sub_queues[i]);
+    }
+    pqFlushBuffers(queue);
+    pqLockWrite(queue);
+    PriorityQueueResult result = pqClearLocked(queue);
+    pqUnlock(queue);
+    return result;
+}
+
+PriorityQueueResult pqSetTrivialDestruction(PriorityQueue queue, bool trivial) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        pqSetTrivialDestruction(queue->sub_queues[i], trivial);
+    }
+    pqLockWrite(queue);
+    queue->trivialDestruction = trivial;
+    pqUnlock(queue);
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqSetLazyDeletion(PriorityQueue queue, double compaction_fraction) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    if (queue->capacity > 0 || compaction_fraction < 0 || compaction_fraction >= 1) {
+        return PQ_ERROR;
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        PriorityQueueResult result = pqSetLazyDeletion(queue->sub_queues[i], compaction_fraction);
+        if (result != PQ_SUCCESS) {
+            return result;
+        }
+    }
+    pqLockWrite(queue);
+    if (compaction_fraction == 0 && queue->entries->dead > 0 &&
+        (pqDetach(queue) != PQ_SUCCESS || pqCompact(queue) == false)) {
+        pqUnlock(queue);
+        return PQ_OUT_OF_MEMORY;
+    }
+    queue->compaction_fraction = compaction_fraction;
+    pqUnlock(queue);
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqFlush(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    return pqFlushBuffers(queue);
+}
+
+PriorityQueueResult pqGetStats(PriorityQueue queue, PQStats *stats) {
+    if (queue == NULL || stats == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    stats->flush_policy = queue->flush_policy;
+    stats->buffer_size = queue->buffer_size;
+    stats->buffers = 0;
+    stats->buffered = 0;
+    if (queue->buffer_size > 0) {
+        pthread_mutex_lock(&queue->buffers_lock);
+        for (pqBuffer buffer = queue->buffers; buffer != NULL; buffer = buffer->next) {
+            pthread_mutex_lock(&buffer->lock);
+            stats->buffered = stats->buffered + buffer->size;
+            pthread_mutex_unlock(&buffer->lock);
+            stats->buffers = stats->buffers + 1;
+        }
+        pthread_mutex_unlock(&queue->buffers_lock);
+    }
+    pqLockRead(queue);
+    stats->flushes = queue->flushes;
+    stats->flushed = queue->flushed;
+    stats->rebuilds = 0;
+    if (queue->backend == PQ_BACKEND_RADIX) {
+        stats->rebuilds = queue->entries->radix->rebuilds;
+    } else if (queue->backend == PQ_BACKEND_WHEEL) {
+        stats->rebuilds = queue->entries->wheel->rebuilds;
+    }
+    stats->tombstones = queue->entries->dead;
+    stats->compactions = queue->compactions;
+    stats->compaction_seconds = queue->compaction_seconds;
+    memset(&stats->counters, 0, sizeof(stats->counters));
+    pqStatsAdd(&stats->counters, queue);
+    pqUnlock(queue);
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        pqLockRead(queue->sub_queues[i]);
+        pqStatsAdd(&stats->counters, queue->sub_queues[i]);
+        pqUnlock(queue->sub_queues[i]);
+    }
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqResetStats(PriorityQueue queue) {
+    if (queue == NULL) {
+        return PQ_NULL_ARGUMENT;
+    }
+    for (int i = 0; i < queue->sub_queue_count; i++) {
+        pqResetStats(queue->sub_queues[i]);
     }
+    pqLockWrite(queue);
+    pqStatsReset(queue);
+    pqUnlock(queue);
     return PQ_SUCCESS;
 }
@@ -2,6 +2,8 @@
 #define PRIORITY_QUEUE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
 * Generic Priority Queue Container
@@ -13,22 +15,55 @@
 *
 * The following functions are available:
 *   pqCreate		    - Creates a new empty priority queue
+*   pqCreateWithBackend - Creates a new empty priority queue with a specific storage backend
+*   pqCreateIndexed     - Creates a new empty priority queue that finds elements through a hash index
+*   pqCreateScalar      - Creates a new empty priority queue whose priorities are integers stored inside the queue
+*   pqCreateConcurrent  - Creates a new empty priority queue that can be used by many threads at once
+*   pqCreateRelaxed     - Creates a new empty priority queue for many threads that removes elements in rough order
+*   pqCreateBuffered    - Creates a new empty priority queue for many threads that buffers the inserts of each one
+*   pqCreateBounded     - Creates a new empty priority queue of fixed capacity that doesn't allocate once created
+*   pqCreateFromArray   - Creates a new priority queue holding arrays of elements and priorities, in O(n)
 *   pqDestroy		    - Deletes an existing priority queue and frees all resources
-*   pqCopy		        - Copies an existing priority queue
+*   pqCopy		        - Copies an existing priority queue, in O(1) until one of the copies is modified
 *   pqGetSize		    - Returns the size of a given priority queue
 *   pqContains	        - returns whether or not an element exists inside the priority queue.
+*                           O(1) expected for an indexed priority queue, O(n) otherwise.
 *   pqInsert	        - Insert an element with a given priority to the queue.
 *   				        Duplication in the priority queue is allowed.
 *   				        Iterator value is undefined after this operation.
+*   pqInsertWithHandle  - Same as pqInsert, and also returns a handle to the inserted entry.
+*   pqInsertTake        - Same as pqInsert, but the priority queue takes the given element and priority
+*                           instead of copying them.
+*   pqInsertBatch       - Inserts arrays of elements and priorities at once, without an O(n) search for each one.
+*   				        Iterator value is undefined after this operation.
 *   pqChangePriority  	- Changes priority of an element with specific priority
 *					        Iterator value is undefined after this operation.
+*   pqChangePriorityByHandle - Changes priority of the entry a handle refers to, without searching for it.
+*					        Iterator value is undefined after this operation.
 *   pqRemove		    - Removes the highest priority element in the queue
 *                           Iterator value is undefined after this operation.
+*   pqRemoveIf          - Removes all the elements that match a predicate, in one pass over the queue
+*                           Iterator value is undefined after this operation.
+*   pqMerge             - Moves all the elements of one priority queue into another, without copying them
+*                           Iterator value is undefined after this operation.
+*   pqPeekTopK          - Returns the k highest priority elements in order, without removing or copying them
+*   pqPopMany           - Removes the k highest priority elements and gives them to the caller
+*                           Iterator value is undefined after this operation.
 *   pqGetFirst	        - Sets the internal iterator to the first element in the priority queue and returns it
 *   pqGetNext		    - Advances the internal iterator to the next key and returns it.
+*   pqIteratorCreate    - Creates an external iterator, independent of the internal one and of other iterators
+*   pqIteratorDestroy   - Deallocates an external iterator
+*   pqIteratorFirst     - Sets an external iterator to the first element in the priority queue and returns it
+*   pqIteratorNext      - Advances an external iterator to the next element and returns it
 *	pqClear		        - Clears the contents of the priority queue. Frees all the elements of
 *	 				        the queue using the free function.
+*   pqSetTrivialDestruction - Declares that pqClear and pqDestroy don't need to free the elements one by one.
+*   pqSetLazyDeletion   - Makes pqRemoveElement leave tombstones behind, compacted away once there are enough of them
+*   pqFlush             - Moves the elements waiting in the insert buffers of a buffered priority queue into it
+*   pqGetStats          - Fills a PQStats with the statistics of the priority queue
+*   pqResetStats        - Zeroes the counters of the priority queue
 * 	PQ_FOREACH	        - A macro for iterating over the priority queue's elements.
+* 	PQ_ITERATOR_FOREACH - A macro for iterating over the priority queue's elements with an external iterator.
 */
 
 /** Type for defining the priority queue */
@@ -41,15 +76,143 @@ typedef enum PriorityQueueResult_t {
     PQ_NULL_ARGUMENT,
     PQ_ELEMENT_DOES_NOT_EXISTS,
     PQ_ITEM_DOES_NOT_EXIST,
-    PQ_ERROR
+    PQ_ERROR,
+    PQ_FULL
 } PriorityQueueResult;
 
+/**
+* Type used for selecting the storage of a priority queue at creation time.
+* All backends keep the same ordering: elements of equal priority come out in FIFO order, the element inserted
+* first (or whose priority was changed first) comes first. Every entry gets an increasing insertion sequence
+* that breaks the ties.
+*   PQ_BACKEND_LIST - a sorted linked list: O(n) insert, O(1) remove of the first element. The list is scanned
+*                     from its end, so inserting an element whose priority is the lowest in the queue (or equal to
+*                     the lowest) is O(1)
+*   PQ_BACKEND_HEAP - an array-backed heap: O(log n) insert and remove of the first element
+*   PQ_BACKEND_RADIX - a radix heap of buckets, only for queues created by pqCreateScalar: O(1) insert and O(1)
+*                      amortised remove of the first element as long as no element is inserted with a higher
+*                      priority than the last one removed, as in a simulation or a scheduler working through time.
+*                      Such an insert is still allowed, but costs an O(n) rebuild of the buckets
+*   PQ_BACKEND_WHEEL - a hierarchical timing wheel, only for queues created by pqCreateScalar, for priorities that
+*                      are points in time such as day numbers. Each level has 64 slots and covers 64 times the range
+*                      of the level below it, so priorities far in the future take no more room. Inserts are O(1),
+*                      and finding the first element is O(1) amortised under the same condition as PQ_BACKEND_RADIX,
+*                      since reaching it only moves the elements of the slots passed on the way. Inserting an
+*                      element with a higher priority than the last one removed costs an O(n) rebuild as well.
+*                      The queue is walked in order slot by slot, and each slot is sorted in place when the walk
+*                      enters it, so a walk sorts only the elements added out of order since the last one
+*   PQ_BACKEND_ARRAY - a structure of arrays, only for queues created by pqCreateScalar: the priorities are kept
+*                      sorted in one contiguous array, apart from the elements. Removing the first element is O(1),
+*                      finding an element by its priority is a binary search, and an insert is a binary search and
+*                      one memmove of the shorter side, O(n) with a small constant. In bench/array_bench (remove the
+*                      first element and insert a random one, built with -O2) it outruns PQ_BACKEND_HEAP up to about
+*                      25000 elements and PQ_BACKEND_LIST from about 4000, and falls behind the heap above that
+*/
+typedef enum PQBackend_t {
+    PQ_BACKEND_LIST,
+    PQ_BACKEND_HEAP,
+    PQ_BACKEND_RADIX,
+    PQ_BACKEND_WHEEL,
+    PQ_BACKEND_ARRAY
+} PQBackend;
+
+/**
+* Type of an opaque handle to a single entry inside a priority queue.
+* A handle stays valid until its entry is removed from the queue or the queue is destroyed.
+*/
+typedef struct PQHandle_t *PQHandle;
+
+/**
+* Type used for selecting when the insert buffers of a priority queue created by pqCreateBuffered are flushed into
+* it. A buffer is always flushed once it is full.
+*   PQ_FLUSH_ON_READ - every function other than the inserts flushes all the buffers first, so it sees every
+*                      element inserted before it was called
+*   PQ_FLUSH_WHEN_FULL - buffers are flushed only once they are full, or by pqFlush. Until then, their elements
+*                        are not seen by the other functions
+*/
+typedef enum PQFlushPolicy_t {
+    PQ_FLUSH_ON_READ,
+    PQ_FLUSH_WHEN_FULL
+} PQFlushPolicy;
+
+/**
+* Type of the counters of the work done by a priority queue, part of its statistics. The counters are only kept when
+* the library is compiled with PQ_STATS defined, otherwise they are always 0 and cost nothing.
+*   comparisons - the amount of times two priorities were compared, by the priority function or as scalars
+*   copy_calls, free_calls, equal_calls, compare_calls, hash_calls - the amount of calls to each kind of function
+*                                                                    given to the queue
+*   inserts - the amount of elements placed in the queue, by an insert or by a change of their priority
+*   insert_traversals - the amount of nodes passed while placing these elements
+*   lookups - the amount of times an element was looked for, by pqContains or by a function that changes it
+*   lookup_traversals - the amount of nodes passed during these lookups
+*   allocations - the amount of memory allocations done by the queue itself, not by the copy functions
+*   allocated_bytes - the total size of these allocations
+*   max_size - the largest amount of elements the queue held, for a relaxed queue the sum of the largest amounts
+*              its sub-queues held
+*/
+typedef struct PQCounters_t {
+    unsigned long comparisons;
+    unsigned long copy_calls;
+    unsigned long free_calls;
+    unsigned long equal_calls;
+    unsigned long compare_calls;
+    unsigned long hash_calls;
+    unsigned long inserts;
+    unsigned long insert_traversals;
+    unsigned long lookups;
+    unsigned long lookup_traversals;
+    unsigned long allocations;
+    unsigned long allocated_bytes;
+    unsigned long max_size;
+} PQCounters;
+
+/**
+* Type of the statistics of a priority queue, filled by pqGetStats.
+*   flush_policy, buffer_size - the settings given to pqCreateBuffered, buffer_size is 0 for other queues
+*   buffers - the amount of insert buffers, one for every thread that inserted into the queue
+*   buffered - the amount of elements waiting in the insert buffers
+*   flushes - the amount of times a non empty buffer was flushed into the queue
+*   flushed - the amount of elements moved from the buffers into the queue
+*   rebuilds - the amount of times the buckets of a PQ_BACKEND_RADIX or PQ_BACKEND_WHEEL queue were rebuilt because
+*              an element was inserted with a higher priority than the last one removed, 0 for other queues
+*   tombstones - the amount of elements removed in lazy deletion mode that are still waiting for a compaction
+*   compactions - the amount of times the tombstones were compacted away, see pqSetLazyDeletion
+*   compaction_seconds - the total time spent in these compactions
+*   counters - the work done by the queue since it was created or since pqResetStats, see PQCounters
+*/
+typedef struct PQStats_t {
+    PQFlushPolicy flush_policy;
+    int buffer_size;
+    int buffers;
+    int buffered;
+    unsigned long flushes;
+    unsigned long flushed;
+    unsigned long rebuilds;
+    int tombstones;
+    unsigned long compactions;
+    double compaction_seconds;
+    PQCounters counters;
+} PQStats;
+
+/**
+* Type of an external iterator over a priority queue.
+* Any number of external iterators can walk the same priority queue at once, without affecting each other or the
+* internal iterator. An iterator is invalidated when its priority queue is modified.
+*/
+typedef struct PQIterator_t *PQIterator;
+
 /** Data element data type for priority queue container */
 typedef void *PQElement;
 
 /** priority data type for priority queue container */
 typedef void *PQElementPriority;
 
+/**
+* Integer priority stored directly inside a scalar priority queue.
+* A lower value is a higher priority, so the smallest value is the first one in the queue.
+*/
+typedef int64_t PQScalarPriority;
+
 /** Type of function for copying a data element of the priority queue */
 typedef PQElement(*CopyPQElement)(PQElement);
 
@@ -71,6 +234,21 @@ typedef void(*FreePQElementPriority)(PQElementPriority);
 */
 typedef bool(*EqualPQElements)(PQElement, PQElement);
 
+/**
+* Type of function used by an indexed priority queue to hash elements.
+* Elements that are equal according to EqualPQElements must have the same hash.
+*/
+typedef unsigned long(*HashPQElement)(PQElement);
+
+/**
+* Type of function used by pqRemoveIf to choose the elements to remove, given an element and the context passed to
+* pqRemoveIf.
+* This function should return:
+* 		true if the element should be removed;
+*		false otherwise;
+*/
+typedef bool(*MatchPQElement)(PQElement, void *);
+
 
 /**
 * Type of function used by the priority queue to compare priorities.
@@ -108,9 +286,228 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
                        FreePQElementPriority free_priority,
                        ComparePQElementPriorities compare_priorities);
 
+/**
+* pqCreateWithBackend: Allocates a new empty priority queue that uses a specific storage backend.
+* pqCreate is the same as calling this function with PQ_BACKEND_LIST.
+*
+* @param backend - The storage the priority queue will use.
+* The rest of the parameters are the same as in pqCreate.
+* @return
+* 	NULL - if one of the parameters is NULL, the backend is unknown or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateWithBackend(PQBackend backend,
+                                  CopyPQElement copy_element,
+                                  FreePQElement free_element,
+                                  EqualPQElements equal_elements,
+                                  CopyPQElementPriority copy_priority,
+                                  FreePQElementPriority free_priority,
+                                  ComparePQElementPriorities compare_priorities);
+
+/**
+* pqCreateIndexed: Allocates a new empty priority queue that keeps a hash index of its elements.
+* pqContains, pqRemoveElement and pqChangePriority find elements through the index in O(1) expected time
+* instead of scanning the priority queue.
+*
+* @param hash_element - Function pointer to be used for hashing elements.
+* The rest of the parameters are the same as in pqCreateWithBackend.
+* @return
+* 	NULL - if one of the parameters is NULL, the backend is unknown or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateIndexed(PQBackend backend,
+                              CopyPQElement copy_element,
+                              FreePQElement free_element,
+                              EqualPQElements equal_elements,
+                              CopyPQElementPriority copy_priority,
+                              FreePQElementPriority free_priority,
+                              ComparePQElementPriorities compare_priorities,
+                              HashPQElement hash_element);
+
+/**
+* pqCreateScalar: Allocates a new empty priority queue whose priorities are PQScalarPriority integers.
+* The priorities are kept inside the queue's entries and compared directly, so no functions are needed for copying,
+* freeing or comparing them. A lower value is a higher priority.
+* Every priority given to the functions of a scalar queue (pqInsert, pqChangePriority etc.) must point to a
+* PQScalarPriority. Its value is read and the pointer is not kept.
+*
+* @param backend - The storage the priority queue will use.
+* @param copy_element - Function pointer to be used for copying data elements.
+* @param free_element - Function pointer to be used for removing data elements.
+* @param equal_elements - Function pointer to be used for identifying equal elements.
+* @param hash_element - Function pointer to be used for hashing elements as in pqCreateIndexed, or NULL for a queue
+*       without an index.
+* @return
+* 	NULL - if one of the element functions is NULL, the backend is unknown or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateScalar(PQBackend backend,
+                             CopyPQElement copy_element,
+                             FreePQElement free_element,
+                             EqualPQElements equal_elements,
+                             HashPQElement hash_element);
+
+/**
+* pqCreateConcurrent: Allocates a new empty priority queue that can be used by many threads at the same time.
+* With PQ_BACKEND_HEAP the priority queue has fine-grained locking: pqInsert, pqInsertWithHandle, pqInsertTake,
+* pqRemove, pqPopMany and pqGetSize run together in any number of threads, each element moving through the heap
+* under the locks of the few positions it is between. Inserts and removals only meet at the top of the heap and at
+* its bottom, so they scale with the number of threads, where a single lock would serialise them. The k elements
+* pqPopMany removes are each the first element when it is removed, but other threads may remove or insert elements
+* between them. The other functions, and all the functions while the priority queue is in lazy deletion mode, have
+* the priority queue to themselves.
+* With the other backends every function takes the read-write lock of the priority queue: functions that only read
+* it (pqGetSize, pqContains, pqPeekTopK and the external iterator functions) can run together in any number of
+* threads, while functions that modify it run alone.
+* Threads that mostly remove elements still meet at the top of the heap, and scale better with pqCreateRelaxed,
+* which spreads them over several priority queues at the cost of a relaxed order.
+* The internal iterator (pqGetFirst, pqGetNext and PQ_FOREACH) is shared by all the threads, so each thread should
+* iterate with an external iterator of its own (pqIteratorCreate and PQ_ITERATOR_FOREACH). As usual, an external
+* iterator stops when another thread modifies the priority queue.
+* The elements pqPeekTopK, pqGetFirst, pqGetNext and the external iterators return are not copied and still belong
+* to the priority queue, so another thread's pqRemove, pqRemoveElement, pqRemoveIf or pqClear may free them as soon
+* as the function returned. Only pqPopMany gives the elements it returns to the caller, so threads that read
+* elements while others remove them should take them with pqPopMany, or otherwise make sure no thread removes them.
+* pqCopy of a concurrent priority queue is a concurrent priority queue with copies of all the elements.
+* pqDestroy must only be called once no other thread uses the priority queue.
+*
+* The parameters are the same as in pqCreateWithBackend.
+* @return
+* 	NULL - if one of the parameters is NULL, the backend is unknown or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateConcurrent(PQBackend backend,
+                                 CopyPQElement copy_element,
+                                 FreePQElement free_element,
+                                 EqualPQElements equal_elements,
+                                 CopyPQElementPriority copy_priority,
+                                 FreePQElementPriority free_priority,
+                                 ComparePQElementPriorities compare_priorities);
+
+/**
+* pqCreateRelaxed: Allocates a new empty relaxed priority queue, which can be used by many threads at the same time
+* and scales with their number better than pqCreateConcurrent, at the cost of removing elements only in rough order
+* of priority.
+* The elements are spread between threads * sub_queues_per_thread concurrent sub-queues. pqInsert puts an element in
+* a random sub-queue, while pqRemove and pqPopMany look at two random sub-queues and take the highest priority
+* element of the better one. Threads rarely pick the same sub-queues, so they rarely wait for each other. The
+* element removed is usually among the highest priority elements, but not necessarily the first one, and elements
+* of the same priority aren't removed in the order they were inserted.
+* pqGetSize, pqContains, pqRemoveElement, pqRemoveIf, pqChangePriority, pqClear, pqSetTrivialDestruction and
+* pqSetLazyDeletion work on all the sub-queues. Since the relaxed priority queue has no order of its own,
+* pqGetFirst, pqGetNext, pqIteratorCreate, pqCopy and pqPeekTopK return NULL or -1, while pqInsertWithHandle with a
+* handle, pqChangePriorityByHandle and pqMerge return PQ_ERROR.
+* pqDestroy must only be called once no other thread uses the priority queue.
+*
+* @param threads - The amount of threads expected to use the priority queue.
+* @param sub_queues_per_thread - The amount of sub-queues for each thread, 2 to 4 is usually enough.
+* The other parameters are the same as in pqCreate.
+* @return
+* 	NULL - if one of the functions is NULL, threads or sub_queues_per_thread isn't positive or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateRelaxed(int threads,
+                              int sub_queues_per_thread,
+                              CopyPQElement copy_element,
+                              FreePQElement free_element,
+                              EqualPQElements equal_elements,
+                              CopyPQElementPriority copy_priority,
+                              FreePQElementPriority free_priority,
+                              ComparePQElementPriorities compare_priorities);
+
+/**
+* pqCreateBuffered: Allocates a new empty concurrent priority queue, as pqCreateConcurrent, for many threads that
+* insert elements and few that read or remove them.
+* pqInsert and pqInsertTake don't take the lock of the priority queue. Instead, each thread appends the element to
+* an insert buffer of its own, and the whole buffer is later flushed into the priority queue at once, as with
+* pqInsertBatch, under a single lock. A buffer is flushed once it holds buffer_size elements, and at the times
+* flush_policy selects.
+* Elements flushed together keep the order of their inserts, but elements inserted by different threads are ordered
+* by the time their buffers were flushed, so elements of equal priority are only FIFO within one thread.
+* pqInsertWithHandle with a handle and pqInsertBatch insert directly, without a buffer.
+* pqCopy of a buffered priority queue is a concurrent priority queue without buffers. pqClear also clears the
+* buffers.
+* pqDestroy must only be called once no other thread uses the priority queue.
+*
+* @param flush_policy - When the buffers are flushed, besides when they are full.
+* @param buffer_size - The amount of elements a buffer holds before it is flushed.
+* The other parameters are the same as in pqCreateWithBackend.
+* @return
+* 	NULL - if one of the parameters is NULL, the backend or the flush policy is unknown, buffer_size isn't positive
+* 	or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateBuffered(PQBackend backend,
+                               PQFlushPolicy flush_policy,
+                               int buffer_size,
+                               CopyPQElement copy_element,
+                               FreePQElement free_element,
+                               EqualPQElements equal_elements,
+                               CopyPQElementPriority copy_priority,
+                               FreePQElementPriority free_priority,
+                               ComparePQElementPriorities compare_priorities);
+
+/**
+* pqCreateBounded: Allocates a new empty priority queue that holds at most capacity elements, for paths that can't
+* afford to allocate memory. All of its storage is allocated up front, and its elements and priorities are kept by
+* value in that storage: pqInsert copies element_size bytes of the element and priority_size bytes of the priority,
+* without any copy functions, and removing them frees nothing.
+* Once created, pqInsert, pqInsertBatch, pqChangePriority, pqRemove, pqRemoveElement, pqContains and pqClear never
+* allocate memory, and an insert into a full priority queue returns PQ_FULL. Iterating over a PQ_BACKEND_HEAP
+* priority queue, pqPeekTopK and pqCopy still allocate, as they do for any other priority queue.
+* The elements returned by the priority queue point into its storage, so they are valid only until they are removed.
+* For the same reason pqInsertTake, pqPopMany and pqMerge are not supported.
+*
+* @param backend - The storage the priority queue will use.
+* @param capacity - The maximum amount of elements in the priority queue.
+* @param element_size - The size of an element in bytes.
+* @param priority_size - The size of a priority in bytes.
+* @param equal_elements - Function pointer to be used for identifying equal elements, given pointers into the
+*       storage of the priority queue.
+* @param compare_priorities - Function pointer to be used for comparing priorities, given pointers into the storage
+*       of the priority queue.
+* @return
+* 	NULL - if one of the functions is NULL, the backend is unknown, one of the sizes isn't positive or allocations
+* 	failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateBounded(PQBackend backend,
+                              int capacity,
+                              size_t element_size,
+                              size_t priority_size,
+                              EqualPQElements equal_elements,
+                              ComparePQElementPriorities compare_priorities);
+
+/**
+* pqCreateFromArray: Allocates a new priority queue that holds copies of count elements with their priorities,
+* as if they were inserted one by one in the order of the arrays.
+* The queue is built in O(n) with PQ_BACKEND_HEAP and in O(n log n) with PQ_BACKEND_LIST, instead of the O(n^2) of
+* repeated pqInsert calls on a list.
+*
+* @param elements - Array of count elements.
+* @param priorities - Array of count priorities, priorities[i] being the priority of elements[i].
+* @param count - The amount of elements, can be 0.
+* The rest of the parameters are the same as in pqCreateWithBackend.
+* @return
+* 	NULL - if one of the parameters is NULL, the backend is unknown, count is negative or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateFromArray(PQBackend backend,
+                                CopyPQElement copy_element,
+                                FreePQElement free_element,
+                                EqualPQElements equal_elements,
+                                CopyPQElementPriority copy_priority,
+                                FreePQElementPriority free_priority,
+                                ComparePQElementPriorities compare_priorities,
+                                PQElement *elements,
+                                PQElementPriority *priorities,
+                                int count);
+
 /**
 * pqDestroy: Deallocates an existing priority queue. Clears all elements by using the
 * free functions.
+* All the entries of the priority queue are released together, not removed one by one, and if the priority queue
+* was declared trivially destructible (see pqSetTrivialDestruction) the free functions are not called at all.
 *
 * @param queue - Target priority queue to be deallocated. If priority queue is NULL nothing will be
 * 		done
@@ -119,6 +516,12 @@ void pqDestroy(PriorityQueue queue);
 
 /**
 * pqCopy: Creates a copy of target priority queue.
+* The copy is made in O(1): both priority queues share their entries until one of them is modified, and only then
+* that priority queue copies all the elements and priorities for itself, with the copy functions given at
+* initialization. Because of that, a modifying function of either priority queue (pqInsert, pqRemove etc.) may
+* return PQ_OUT_OF_MEMORY if that copy fails, and the elements returned by iterating over one priority queue may be
+* the same elements returned by the other until then.
+* Handles of target priority queue remain valid for it, and are not valid for the copy.
 * Iterator values for both priority queues are undefined after this operation.
 *
 * @param queue - Target priority queue.
@@ -164,10 +567,63 @@ bool pqContains(PriorityQueue queue, PQElement element);
 * 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
 * 	PQ_OUT_OF_MEMORY if an allocation failed (Meaning the function for copying
 * 	an element failed)
+* 	PQ_FULL if the priority queue was created by pqCreateBounded and holds capacity elements
 * 	PQ_SUCCESS the paired elements had been inserted successfully
 */
 PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority);
 
+/**
+*   pqInsertWithHandle: add a specified element with a specific priority, and return a handle to the new entry.
+*   Iterator's value is undefined after this operation.
+*
+* @param handle - Pointer that receives the handle of the new entry, can be NULL if the handle is not needed.
+* The rest of the parameters and the return values are the same as in pqInsert.
+*/
+PriorityQueueResult pqInsertWithHandle(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                       PQHandle *handle);
+
+/**
+*   pqInsertTake: add a specified element with a specific priority, taking ownership of both instead of copying them.
+*   On success the element and priority belong to the priority queue, which frees them with the free functions given
+*   at initialization. On failure they still belong to the caller.
+*   In a scalar priority queue only the element is taken, the priority's value is read as in pqInsert.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue for which to add the data element
+* @param element - The element which need to be added, it is not copied.
+* @param priority - The priority to associate with the given element, it is not copied.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_OUT_OF_MEMORY if an allocation failed
+* 	PQ_ERROR if the priority queue was created by pqCreateBounded, which can't take elements it doesn't store
+* 	PQ_SUCCESS the paired elements had been inserted successfully
+*/
+PriorityQueueResult pqInsertTake(PriorityQueue queue, PQElement element, PQElementPriority priority);
+
+/**
+*   pqInsertBatch: add count elements with their priorities, as if pqInsert was called for each of them in the order
+*   of the arrays, but without searching the priority queue once per element.
+*   The entries of the whole batch are allocated together. With PQ_BACKEND_HEAP the heap is rebuilt in O(n + count)
+*   when the batch is larger than the priority queue, with PQ_BACKEND_LIST or PQ_BACKEND_ARRAY the batch is sorted and
+*   merged into the list or the array in O(n + count log count), and with PQ_BACKEND_RADIX or PQ_BACKEND_WHEEL each
+*   entry is added in O(1).
+*   Either all the elements are inserted, or none of them are.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue for which to add the data elements
+* @param elements - Array of count elements, each of them is copied as in pqInsert.
+* @param priorities - Array of count priorities, priorities[i] being the priority of elements[i].
+* @param count - The amount of elements to add.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters or inside the arrays
+* 	PQ_ERROR if count is negative
+* 	PQ_OUT_OF_MEMORY if an allocation failed, the priority queue is unchanged in that case
+* 	PQ_FULL if the priority queue was created by pqCreateBounded and has no room for all the elements, the priority
+* 	queue is unchanged in that case
+* 	PQ_SUCCESS the elements had been inserted successfully
+*/
+PriorityQueueResult pqInsertBatch(PriorityQueue queue, PQElement *elements, PQElementPriority *priorities, int count);
+
 /**
 *	pqChangePriority: Changes a priority of specific element with a specific priority in the priority queue.
 *           If there are multiple same elements with same priority,
@@ -189,6 +645,22 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
 PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
                                      PQElementPriority old_priority, PQElementPriority new_priority);
 
+/**
+*	pqChangePriorityByHandle: Changes the priority of the entry a handle refers to.
+*           The entry is considered as reinserted, but it is moved in place: the element is not copied or freed,
+*           only the new priority is copied. This takes O(log n) with PQ_BACKEND_HEAP.
+*			Iterator's value is undefined after this operation
+*
+* @param queue - The priority queue the entry belongs to.
+* @param handle - A handle of an entry in queue, as returned by pqInsertWithHandle.
+* @param new_priority - The new priority of the entry.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_OUT_OF_MEMORY if copying the new priority failed, the entry is unchanged in that case
+* 	PQ_SUCCESS the priority had been changed successfully
+*/
+PriorityQueueResult pqChangePriorityByHandle(PriorityQueue queue, PQHandle handle, PQElementPriority new_priority);
+
 /**
 *   pqRemove: Removes the highest priority element from the priority queue.
 *   If there are multiple elements with the same highest priority, the first inserted element should be removed first.
@@ -206,6 +678,8 @@ PriorityQueueResult pqRemove(PriorityQueue queue);
 *   pqRemoveElement: Removes the highest priority element from the priority queue which have its value equal to element.
 *   If there are multiple elements with the same highest priority, the first inserted element should be removed first.
 *   the elements are removed and deallocated using the free functions supplied at initialization.
+*   In lazy deletion mode (see pqSetLazyDeletion) only the element is freed, and its priority is freed once its
+*   tombstone is compacted away.
 *   Iterator's value is undefined after this operation.
 *
 * @param queue - The priority queue to remove the elements from.
@@ -220,16 +694,93 @@ PriorityQueueResult pqRemove(PriorityQueue queue);
 */
 PriorityQueueResult pqRemoveElement(PriorityQueue queue, PQElement element);
 
+/**
+*   pqRemoveIf: Removes every element of the priority queue for which predicate returns true, with its priority.
+*   The elements are removed and deallocated using the free functions supplied at initialization.
+*   The queue is walked once: a list drops the matching elements as it is walked, in O(n), while the other backends
+*   check all the elements first and then remove the matching ones, in O(n + k log n) with PQ_BACKEND_HEAP for k
+*   removed elements. The predicate must not modify the priority queue.
+*   pqRemoveIf is for predicates that don't follow the order of the queue. Elements that make up the front of the
+*   queue, such as those due before a point in time, are removed faster by pqRemove until the first element doesn't
+*   match, which touches only the removed elements.
+*   Iterator's value is undefined after this operation, unless no element was removed.
+*
+* @param queue - The priority queue to remove the elements from.
+* @param predicate - The function that chooses the elements to remove.
+* @param context - Passed to predicate with every element, may be NULL.
+* @return
+* 	-1 if a NULL pointer was sent as queue or predicate, or a memory allocation failed, the priority queue is
+* 	unchanged in that case (except for the sub-queues a relaxed priority queue already went through).
+* 	Otherwise the amount of elements removed.
+*/
+int pqRemoveIf(PriorityQueue queue, MatchPQElement predicate, void *context);
+
+/**
+*	pqMerge: Moves all the elements of source into destination, leaving source empty. The entries of source are
+*	moved as they are, without copying or freeing any element or priority.
+*	Elements of equal priority keep their order: those of destination come before those of source.
+*	With PQ_BACKEND_LIST the two lists are merged in O(n + m), and with PQ_BACKEND_HEAP the entries of source are
+*	added to the heap, which is rebuilt in O(n + m) when source is the larger one. Queues with different backends
+*	can be merged as well, at the cost of sorting source when destination is a list or a radix heap.
+*	Iterator values for both priority queues are undefined after this operation.
+*
+* @param destination - The priority queue that receives the elements.
+* @param source - The priority queue whose elements are moved, it is still valid and has to be destroyed as usual.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_ERROR if source and destination are the same queue, or don't use the same functions for elements and
+* 	priorities
+* 	PQ_OUT_OF_MEMORY if an allocation failed, both priority queues are unchanged in that case
+* 	PQ_SUCCESS the elements had been moved successfully
+*/
+PriorityQueueResult pqMerge(PriorityQueue destination, PriorityQueue source);
+
+/**
+*	pqPeekTopK: Retrieves the k highest priority elements of the priority queue, in the order they would be removed.
+*	The elements are not copied and still belong to the priority queue, they must not be changed or freed. In a
+*	concurrent priority queue another thread may remove and free them once pqPeekTopK returns, see pqCreateConcurrent.
+*	Costs O(k) with PQ_BACKEND_LIST and O(k log k) with PQ_BACKEND_HEAP, without a pass over the whole queue.
+*	Iterators are not affected by this operation.
+*
+* @param queue - The priority queue to look at.
+* @param k - The amount of elements requested.
+* @param out_elements - An array of at least k elements, which receives the elements.
+* @return
+* 	-1 if a NULL pointer was sent, k is negative or a memory allocation failed.
+* 	Otherwise the amount of elements written to out_elements, which is k or the size of the queue if it is smaller.
+*/
+int pqPeekTopK(PriorityQueue queue, int k, PQElement *out_elements);
+
+/**
+*	pqPopMany: Removes the k highest priority elements from the priority queue in one operation, in the order
+*	pqRemove would remove them, in O(k) with PQ_BACKEND_LIST and O(k log n) with PQ_BACKEND_HEAP.
+*	The elements are not freed: they are written to out_elements and belong to the caller from then on, who has to
+*	free them (the priorities are freed by the priority queue as in pqRemove).
+*	Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue to remove the elements from.
+* @param k - The amount of elements to remove.
+* @param out_elements - An array of at least k elements, which receives the elements.
+* @return
+* 	-1 if a NULL pointer was sent, k is negative, a memory allocation failed or the priority queue was created by
+* 	pqCreateBounded, whose elements can't be given away.
+* 	Otherwise the amount of elements removed, which is k or the size of the queue if it is smaller.
+*/
+int pqPopMany(PriorityQueue queue, int k, PQElement *out_elements);
+
 /**
 *	pqGetFirst: Sets the internal iterator (also called current element) to
 *	the first element in the priority queue. The internal order derived from the priorities, and the tie-breaker between
 *   two equal priorities is the insertion order.
 *	Use this to start iterating over the priority queue.
 *	To continue iteration use pqGetNext
+*   A PQ_BACKEND_LIST queue is walked along its list, and a PQ_BACKEND_WHEEL queue along its slots, sorting each
+*   one as the walk enters it. With the other backends, pqGetFirst takes a sorted snapshot of the queue in
+*   O(n log n), so a queue that is walked often should use PQ_BACKEND_LIST or PQ_BACKEND_WHEEL.
 *
 * @param queue - The priority queue for which to set the iterator and return the first element.
 * @return
-* 	NULL if a NULL pointer was sent or the priority queue is empty.
+* 	NULL if a NULL pointer was sent, the priority queue is empty or the snapshot couldn't be allocated.
 * 	The first key element of the priority queue otherwise
 */
 PQElement pqGetFirst(PriorityQueue queue);
@@ -248,6 +799,8 @@ PQElement pqGetNext(PriorityQueue queue);
 /**
 * pqClear: Removes all elements and priorities from target priority queue.
 * The elements are deallocated using the stored free functions.
+* As in pqDestroy, the entries are released together, and the free functions are not called if the priority queue
+* was declared trivially destructible.
 * @param queue
 * 	Target priority queue to remove all element from.
 * @return
@@ -256,6 +809,117 @@ PQElement pqGetNext(PriorityQueue queue);
 */
 PriorityQueueResult pqClear(PriorityQueue queue);
 
+/**
+* pqSetTrivialDestruction: Declares whether the elements and priorities of the priority queue are trivially
+* destructible, meaning that nothing is lost if they are never passed to the free functions, for example when
+* they are owned by some other structure of the user.
+* When set, pqClear and pqDestroy release all the entries at once without calling the free functions for each of
+* them. Other functions that remove elements (pqRemove, pqRemoveElement) still free them.
+* A new priority queue is not trivially destructible, and copies made by pqCopy keep the setting of their source.
+*
+* @param queue - Target priority queue.
+* @param trivial - Whether the elements and priorities are trivially destructible.
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqSetTrivialDestruction(PriorityQueue queue, bool trivial);
+
+/**
+* pqSetLazyDeletion: Turns lazy deletion on or off. In lazy deletion mode pqRemoveElement frees the element it
+* finds but leaves its entry behind as a tombstone, in O(1) expected time for an indexed priority queue instead of
+* unlinking the entry from the list, the heap or the buckets. Tombstones are never returned by any function: pqRemove,
+* pqPopMany and the iterators skip them, and pqRemove and pqPopMany drop those they meet at the head of the queue.
+* Once tombstones are more than compaction_fraction of all the entries, they are all compacted away in one pass.
+* A new priority queue doesn't use lazy deletion, and copies made by pqCopy keep the setting of their source.
+*
+* @param queue - Target priority queue.
+* @param compaction_fraction - The fraction of tombstones among the entries that triggers a compaction, below 1.
+* 	0 turns lazy deletion off, compacting the tombstones that are left.
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_ERROR - if compaction_fraction is negative or not below 1, or the priority queue was created by
+* 	pqCreateBounded, whose entries are reused in place.
+* 	PQ_OUT_OF_MEMORY - if turning lazy deletion off failed to compact the tombstones, the setting is unchanged then.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqSetLazyDeletion(PriorityQueue queue, double compaction_fraction);
+
+/**
+* pqFlush: Moves the elements waiting in the insert buffers of a priority queue created by pqCreateBuffered into
+* the priority queue, whatever its flush policy. Does nothing for other priority queues.
+*
+* @param queue - Target priority queue.
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_OUT_OF_MEMORY - if allocations failed, the elements that were not flushed stay in their buffers.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqFlush(PriorityQueue queue);
+
+/**
+* pqGetStats: Fills stats with the statistics of the priority queue. Elements may be added to the buffers of other
+* threads while the statistics are gathered.
+*
+* @param queue - Target priority queue.
+* @param stats - The statistics to fill.
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqGetStats(PriorityQueue queue, PQStats *stats);
+
+/**
+* pqResetStats: Zeroes the counters of the priority queue, so the work done from now on can be told apart from the
+* work done before. max_size starts again from the current size of the queue.
+*
+* @param queue - Target priority queue.
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqResetStats(PriorityQueue queue);
+
+/**
+*	pqIteratorCreate: Allocates a new external iterator over a priority queue.
+*	The iterator must be deallocated before its priority queue is destroyed.
+*
+* @param queue - The priority queue to iterate over.
+* @return
+* 	NULL if a NULL pointer was sent or allocation failed.
+* 	A new iterator that is not pointing at any element otherwise.
+*/
+PQIterator pqIteratorCreate(PriorityQueue queue);
+
+/**
+*	pqIteratorDestroy: Deallocates an external iterator. If iterator is NULL nothing will be done.
+*
+* @param iterator - The iterator to deallocate.
+*/
+void pqIteratorDestroy(PQIterator iterator);
+
+/**
+*	pqIteratorFirst: Sets an external iterator to the first element in its priority queue, in the same order as
+*	pqGetFirst.
+*
+* @param iterator - The iterator to set.
+* @return
+* 	NULL if a NULL pointer was sent or the priority queue is empty.
+* 	The first element of the priority queue otherwise.
+*/
+PQElement pqIteratorFirst(PQIterator iterator);
+
+/**
+*	pqIteratorNext: Advances an external iterator to the next element and returns it.
+*
+* @param iterator - The iterator to advance.
+* @return
+* 	NULL if reached the end of the priority queue, the priority queue was modified since pqIteratorFirst
+* 	or a NULL sent as argument
+* 	The next element on the priority queue in case of success
+*/
+PQElement pqIteratorNext(PQIterator iterator);
+
 /*!
 * Macro for iterating over a priority queue.
 * Declares a new iterator for the loop.
@@ -265,4 +929,13 @@ PriorityQueueResult pqClear(PriorityQueue queue);
         iterator ;\
         iterator = pqGetNext(queue))
 
+/*!
+* Macro for iterating over a priority queue with an external iterator.
+* Declares a new element variable for the loop.
+*/
+#define PQ_ITERATOR_FOREACH(type, element, iterator) \
+    for(type element = (type) pqIteratorFirst(iterator) ; \
+        element ;\
+        element = pqIteratorNext(iterator))
+
 #endif /* PRIORITY_QUEUE_H_ */
@@ -0,0 +1,379 @@
+#ifndef PRIORITY_QUEUE_TYPED_H
+#define PRIORITY_QUEUE_TYPED_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "priority_queue.h"
+
+/**
+* Typed Priority Queue Generator
+*
+* PQ_DEFINE(Name, Element, Priority, compare_priorities, equal_elements) defines a priority queue type called Name
+* whose elements of type Element and priorities of type Priority are stored by value, inside the array of a heap,
+* instead of being copied into boxes of their own and reached through void pointers. The two functions are given at
+* compile time, so the compiler can inline them:
+*   int compare_priorities(Priority first, Priority second) - as ComparePQElementPriorities: positive if first is
+*       the higher priority, 0 if they are equal and negative otherwise
+*   bool equal_elements(const Element *first, const Element *second) - as EqualPQElements
+*
+* The functions of the queue have the same shape and meaning as those of priority_queue.h, with the name of the queue
+* in place of pq. Elements are passed by pointer and copied into the queue, priorities are passed by value:
+*   NameCreate          - Creates a new empty priority queue
+*   NameDestroy         - Deletes an existing priority queue and frees all resources
+*   NameCopy            - Copies an existing priority queue
+*   NameGetSize         - Returns the size of a given priority queue
+*   NameContains        - returns whether or not an element exists inside the priority queue
+*   NameInsert          - Insert an element with a given priority to the queue, in O(log n)
+*   NameChangePriority  - Changes priority of an element with specific priority
+*   NameRemove          - Removes the highest priority element in the queue, in O(log n)
+*   NameRemoveElement   - Removes the highest priority element equal to a given element
+*   NameGetFirst        - Sets the internal iterator to the first element in the priority queue and returns it.
+*                           Sorts the queue in O(n log n) when it changed since the last time
+*   NameGetNext         - Advances the internal iterator to the next element and returns it
+*   NameClear           - Clears the contents of the priority queue
+*   PQ_TYPED_FOREACH    - A macro for iterating over the priority queue's elements
+* The results are the PriorityQueueResult values of priority_queue.h, with the same meaning. Elements of equal
+* priority come out in FIFO order as well, and the iterator is undefined after every function that changes the
+* queue, as in priority_queue.h.
+*
+* Elements that own resources, such as a name or a queue of their own, are copied and freed by the two functions
+* given to NameCreate. When they are NULL, an element is copied by assignment and nothing is freed. Their types are:
+*   NameCopyElement - bool copy(Element *destination, const Element *source), false if memory allocation failed
+*   NameFreeElement - void free(Element *element)
+*
+* PQ_DEFINE defines static functions, so it can be used in every file that needs the queue, followed by a semicolon.
+*/
+
+#define PQ_TYPED_ARITY 4
+#define PQ_TYPED_INITIAL_CAPACITY 16
+#define PQ_TYPED_NOT_FOUND -1
+
+/**
+* Defines a priority queue called Name, see above.
+* The entries are kept by value in entries, a 4-ary heap whose top is the highest priority entry. NameGetFirst sorts
+* the heap in place before iterating over it, which leaves it a valid heap, and sorted records that it needs no
+* sorting until the queue changes. The internal iterator is the position of the current entry, or PQ_TYPED_NOT_FOUND
+* when it is undefined.
+*/
+#define PQ_DEFINE(Name, Element, Priority, compare_priorities, equal_elements) \
+    typedef struct Name##_t *Name; \
+    typedef bool (*Name##CopyElement)(Element *, const Element *); \
+    typedef void (*Name##FreeElement)(Element *); \
+    \
+    typedef struct Name##Entry_t { \
+        Element element; \
+        Priority priority; \
+        unsigned long sequence; \
+    } Name##Entry; \
+    \
+    struct Name##_t { \
+        Name##Entry *entries; \
+        int size; \
+        int capacity; \
+        int iterator; \
+        bool sorted; \
+        unsigned long next_sequence; \
+        Name##CopyElement copyElement; \
+        Name##FreeElement freeElement; \
+    }; \
+    \
+    static inline bool Name##EntryBefore(const Name##Entry *first, const Name##Entry *second) { \
+        int result = compare_priorities(first->priority, second->priority); \
+        return result > 0 || (result == 0 && first->sequence < second->sequence); \
+    } \
+    \
+    static inline bool Name##CopyValue(Name queue, Element *destination, const Element *source) { \
+        if (queue->copyElement == NULL) { \
+            *destination = *source; \
+            return true; \
+        } \
+        return queue->copyElement(destination, source); \
+    } \
+    \
+    static inline void Name##FreeValue(Name queue, Element *element) { \
+        if (queue->freeElement != NULL) { \
+            queue->freeElement(element); \
+        } \
+    } \
+    \
+    static inline bool Name##Grow(Name queue) { \
+        if (queue->size < queue->capacity) { \
+            return true; \
+        } \
+        int new_capacity = queue->capacity == 0 ? PQ_TYPED_INITIAL_CAPACITY : queue->capacity * 2; \
+        Name##Entry *new_entries = realloc(queue->entries, sizeof(*new_entries) * new_capacity); \
+        if (new_entries == NULL) { \
+            return false; \
+        } \
+        queue->entries = new_entries; \
+        queue->capacity = new_capacity; \
+        return true; \
+    } \
+    \
+    static inline void Name##SiftUp(Name queue, int index) { \
+        Name##Entry entry = queue->entries[index]; \
+        while (index > 0) { \
+            int parent = (index - 1) / PQ_TYPED_ARITY; \
+            if (Name##EntryBefore(&entry, &queue->entries[parent]) == false) { \
+                break; \
+            } \
+            queue->entries[index] = queue->entries[parent]; \
+            index = parent; \
+        } \
+        queue->entries[index] = entry; \
+    } \
+    \
+    static inline void Name##SiftDown(Name queue, int index, int size) { \
+        Name##Entry entry = queue->entries[index]; \
+        while (true) { \
+            int first_child = index * PQ_TYPED_ARITY + 1; \
+            if (first_child >= size) { \
+                break; \
+            } \
+            int last_child = first_child + PQ_TYPED_ARITY < size ? first_child + PQ_TYPED_ARITY : size; \
+            int best = first_child; \
+            for (int child = first_child + 1; child < last_child; child++) { \
+                if (Name##EntryBefore(&queue->entries[child], &queue->entries[best])) { \
+                    best = child; \
+                } \
+            } \
+            if (Name##EntryBefore(&queue->entries[best], &entry) == false) { \
+                break; \
+            } \
+            queue->entries[index] = queue->entries[best]; \
+            index = best; \
+        } \
+        queue->entries[index] = entry; \
+    } \
+    \
+    static inline void Name##Update(Name queue, int index) { \
+        if (index > 0 && \
+            Name##EntryBefore(&queue->entries[index], &queue->entries[(index - 1) / PQ_TYPED_ARITY])) { \
+            Name##SiftUp(queue, index); \
+        } else { \
+            Name##SiftDown(queue, index, queue->size); \
+        } \
+    } \
+    \
+    static inline void Name##RemoveAt(Name queue, int index) { \
+        Name##FreeValue(queue, &queue->entries[index].element); \
+        queue->size = queue->size - 1; \
+        queue->sorted = false; \
+        if (index != queue->size) { \
+            queue->entries[index] = queue->entries[queue->size]; \
+            Name##Update(queue, index); \
+        } \
+    } \
+    \
+    static inline void Name##Sort(Name queue) { \
+        for (int size = queue->size - 1; size > 0; size--) { \
+            Name##Entry top = queue->entries[0]; \
+            queue->entries[0] = queue->entries[size]; \
+            queue->entries[size] = top; \
+            Name##SiftDown(queue, 0, size); \
+        } \
+        for (int low = 0, high = queue->size - 1; low < high; low++, high--) { \
+            Name##Entry entry = queue->entries[low]; \
+            queue->entries[low] = queue->entries[high]; \
+            queue->entries[high] = entry; \
+        } \
+        queue->sorted = true; \
+    } \
+    \
+    static inline int Name##Find(Name queue, const Element *element, const Priority *priority) { \
+        int found = PQ_TYPED_NOT_FOUND; \
+        for (int i = 0; i < queue->size; i++) { \
+            if ((priority == NULL || compare_priorities(queue->entries[i].priority, *priority) == 0) && \
+                equal_elements(&queue->entries[i].element, element) && \
+                (found == PQ_TYPED_NOT_FOUND || Name##EntryBefore(&queue->entries[i], &queue->entries[found]))) { \
+                found = i; \
+            } \
+        } \
+        return found; \
+    } \
+    \
+    static inline Name Name##Create(Name##CopyElement copy_element, Name##FreeElement free_element) { \
+        Name queue = malloc(sizeof(*queue)); \
+        if (queue == NULL) { \
+            return NULL; \
+        } \
+        queue->entries = NULL; \
+        queue->size = 0; \
+        queue->capacity = 0; \
+        queue->iterator = PQ_TYPED_NOT_FOUND; \
+        queue->sorted = true; \
+        queue->next_sequence = 0; \
+        queue->copyElement = copy_element; \
+        queue->freeElement = free_element; \
+        return queue; \
+    } \
+    \
+    static inline PriorityQueueResult Name##Clear(Name queue) { \
+        if (queue == NULL) { \
+            return PQ_NULL_ARGUMENT; \
+        } \
+        for (int i = 0; i < queue->size; i++) { \
+            Name##FreeValue(queue, &queue->entries[i].element); \
+        } \
+        queue->size = 0; \
+        queue->iterator = PQ_TYPED_NOT_FOUND; \
+        queue->sorted = true; \
+        return PQ_SUCCESS; \
+    } \
+    \
+    static inline void Name##Destroy(Name queue) { \
+        if (queue == NULL) { \
+            return; \
+        } \
+        Name##Clear(queue); \
+        free(queue->entries); \
+        free(queue); \
+    } \
+    \
+    static inline Name Name##Copy(Name queue) { \
+        if (queue == NULL) { \
+            return NULL; \
+        } \
+        Name new_queue = Name##Create(queue->copyElement, queue->freeElement); \
+        if (new_queue == NULL) { \
+            return NULL; \
+        } \
+        new_queue->capacity = queue->size > 0 ? queue->size : 1; \
+        new_queue->entries = malloc(sizeof(*new_queue->entries) * new_queue->capacity); \
+        if (new_queue->entries == NULL) { \
+            free(new_queue); \
+            return NULL; \
+        } \
+        for (int i = 0; i < queue->size; i++) { \
+            new_queue->entries[i] = queue->entries[i]; \
+            if (Name##CopyValue(queue, &new_queue->entries[i].element, &queue->entries[i].element) == false) { \
+                Name##Destroy(new_queue); \
+                return NULL; \
+            } \
+            new_queue->size = i + 1; \
+        } \
+        new_queue->sorted = queue->sorted; \
+        new_queue->next_sequence = queue->next_sequence; \
+        queue->iterator = PQ_TYPED_NOT_FOUND; \
+        return new_queue; \
+    } \
+    \
+    static inline int Name##GetSize(Name queue) { \
+        if (queue == NULL) { \
+            return -1; \
+        } \
+        return queue->size; \
+    } \
+    \
+    static inline bool Name##Contains(Name queue, const Element *element) { \
+        if (queue == NULL || element == NULL) { \
+            return false; \
+        } \
+        for (int i = 0; i < queue->size; i++) { \
+            if (equal_elements(&queue->entries[i].element, element)) { \
+                return true; \
+            } \
+        } \
+        return false; \
+    } \
+    \
+    static inline PriorityQueueResult Name##Insert(Name queue, const Element *element, Priority priority) { \
+        if (queue == NULL || element == NULL) { \
+            return PQ_NULL_ARGUMENT; \
+        } \
+        queue->iterator = PQ_TYPED_NOT_FOUND; \
+        if (Name##Grow(queue) == false) { \
+            return PQ_OUT_OF_MEMORY; \
+        } \
+        Name##Entry *entry = &queue->entries[queue->size]; \
+        if (Name##CopyValue(queue, &entry->element, element) == false) { \
+            return PQ_OUT_OF_MEMORY; \
+        } \
+        entry->priority = priority; \
+        entry->sequence = queue->next_sequence; \
+        queue->next_sequence = queue->next_sequence + 1; \
+        queue->size = queue->size + 1; \
+        queue->sorted = queue->sorted && (queue->size == 1 || \
+                                          Name##EntryBefore(&queue->entries[queue->size - 2], entry)); \
+        Name##SiftUp(queue, queue->size - 1); \
+        return PQ_SUCCESS; \
+    } \
+    \
+    static inline PriorityQueueResult Name##ChangePriority(Name queue, const Element *element, \
+                                                           Priority old_priority, Priority new_priority) { \
+        if (queue == NULL || element == NULL) { \
+            return PQ_NULL_ARGUMENT; \
+        } \
+        queue->iterator = PQ_TYPED_NOT_FOUND; \
+        int index = Name##Find(queue, element, &old_priority); \
+        if (index == PQ_TYPED_NOT_FOUND) { \
+            return PQ_ELEMENT_DOES_NOT_EXISTS; \
+        } \
+        queue->entries[index].priority = new_priority; \
+        queue->entries[index].sequence = queue->next_sequence; \
+        queue->next_sequence = queue->next_sequence + 1; \
+        queue->sorted = false; \
+        Name##Update(queue, index); \
+        return PQ_SUCCESS; \
+    } \
+    \
+    static inline PriorityQueueResult Name##Remove(Name queue) { \
+        if (queue == NULL) { \
+            return PQ_NULL_ARGUMENT; \
+        } \
+        queue->iterator = PQ_TYPED_NOT_FOUND; \
+        if (queue->size > 0) { \
+            Name##RemoveAt(queue, 0); \
+        } \
+        return PQ_SUCCESS; \
+    } \
+    \
+    static inline PriorityQueueResult Name##RemoveElement(Name queue, const Element *element) { \
+        if (queue == NULL || element == NULL) { \
+            return PQ_NULL_ARGUMENT; \
+        } \
+        queue->iterator = PQ_TYPED_NOT_FOUND; \
+        int index = Name##Find(queue, element, NULL); \
+        if (index == PQ_TYPED_NOT_FOUND) { \
+            return PQ_ELEMENT_DOES_NOT_EXISTS; \
+        } \
+        Name##RemoveAt(queue, index); \
+        return PQ_SUCCESS; \
+    } \
+    \
+    static inline Element *Name##GetFirst(Name queue) { \
+        if (queue == NULL || queue->size == 0) { \
+            return NULL; \
+        } \
+        if (queue->sorted == false) { \
+            Name##Sort(queue); \
+        } \
+        queue->iterator = 0; \
+        return &queue->entries[0].element; \
+    } \
+    \
+    static inline Element *Name##GetNext(Name queue) { \
+        if (queue == NULL || queue->iterator == PQ_TYPED_NOT_FOUND) { \
+            return NULL; \
+        } \
+        queue->iterator = queue->iterator + 1; \
+        if (queue->iterator >= queue->size) { \
+            queue->iterator = PQ_TYPED_NOT_FOUND; \
+            return NULL; \
+        } \
+        return &queue->entries[queue->iterator].element; \
+    } \
+    \
+    struct Name##_t
+
+/*!
+* Macro for iterating over a typed priority queue called Name.
+* Declares a new element variable for the loop, of type, a pointer to the elements of the queue.
+*/
+#define PQ_TYPED_FOREACH(Name, type, iterator, queue) \
+    for(type iterator = Name##GetFirst(queue) ; \
+        iterator ;\
+        iterator = Name##GetNext(queue))
+
+#endif //PRIORITY_QUEUE_TYPED_H
@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test_utilities.h"
+#include "../event_manager.h"
+
+#define EVENTS_FILE "event_manager_tests_events.txt"
+#define MEMBERS_FILE "event_manager_tests_members.txt"
+#define FILE_SIZE 1000
+
+/**
+ * fileEquals: Checks that a file holds exactly the text expected, and deletes it
+ */
+static bool fileEquals(const char *file_name, const char *expected) {
+    char text[FILE_SIZE] = "";
+    FILE *file = fopen(file_name, "r");
+    if (file == NULL) {
+        return false;
+    }
+    size_t length = fread(text, 1, sizeof(text) - 1, file);
+    text[length] = '\0';
+    fclose(file);
+    remove(file_name);
+    return strcmp(text, expected) == 0;
+}
+
+static bool testEMCreateDestroy() {
+    bool result = true;
+    Date date = dateCreate(1, 1, 2020);
+    ASSERT_TEST(date != NULL, returnLabel);
+    EventManager em = createEventManager(date);
+    ASSERT_TEST(em != NULL, destroyDateLabel);
+    ASSERT_TEST(emGetEventsAmount(em) == 0, destroyLabel);
+    ASSERT_TEST(emGetNextEvent(em) == NULL, destroyLabel);
+
+destroyLabel:
+    destroyEventManager(em);
+destroyDateLabel:
+    dateDestroy(date);
+returnLabel:
+    return result;
+}
+
+static bool testEMAddAndRemoveEvents() {
+    bool result = true;
+    Date date = dateCreate(1, 1, 2020);
+    ASSERT_TEST(date != NULL, returnLabel);
+    EventManager em = createEventManager(date);
+    ASSERT_TEST(em != NULL, destroyDateLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "late", 10, 1) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "early", 2, 2) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "tied", 2, 3) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddEventByDate(em, "late", date, 4) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "late", 10, 5) == EM_EVENT_ALREADY_EXISTS, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "other", 3, 1) == EM_EVENT_ID_ALREADY_EXISTS, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "past", -1, 6) == EM_INVALID_DATE, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "negative", 1, -1) == EM_INVALID_EVENT_ID, destroyLabel);
+    ASSERT_TEST(emGetEventsAmount(em) == 4, destroyLabel);
+    ASSERT_TEST(strcmp(emGetNextEvent(em), "late") == 0, destroyLabel);
+    ASSERT_TEST(emRemoveEvent(em, 4) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emRemoveEvent(em, 4) == EM_EVENT_NOT_EXISTS, destroyLabel);
+    ASSERT_TEST(strcmp(emGetNextEvent(em), "early") == 0, destroyLabel);
+    emPrintAllEvents(em, EVENTS_FILE);
+    ASSERT_TEST(fileEquals(EVENTS_FILE, "early,3.1.2020\ntied,3.1.2020\nlate,11.1.2020\n"), destroyLabel);
+
+destroyLabel:
+    destroyEventManager(em);
+destroyDateLabel:
+    dateDestroy(date);
+returnLabel:
+    return result;
+}
+
+static bool testEMChangeDateAndTick() {
+    bool result = true;
+    Date date = dateCreate(1, 1, 2020);
+    Date new_date = dateCreate(20, 1, 2020);
+    ASSERT_TEST(date != NULL && new_date != NULL, destroyDateLabel);
+    EventManager em = createEventManager(date);
+    ASSERT_TEST(em != NULL, destroyDateLabel);
+    for (int id = 1; id <= 5; id++) {
+        char name[] = "event0";
+        name[5] = (char) ('0' + id);
+        ASSERT_TEST(emAddEventByDiff(em, name, (id - 1) * 3, id) == EM_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(emChangeEventDate(em, 1, new_date) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emChangeEventDate(em, 9, new_date) == EM_EVENT_ID_NOT_EXISTS, destroyLabel);
+    ASSERT_TEST(strcmp(emGetNextEvent(em), "event2") == 0, destroyLabel);
+    ASSERT_TEST(emTick(em, 0) == EM_INVALID_DATE, destroyLabel);
+    ASSERT_TEST(emTick(em, 7) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emGetEventsAmount(em) == 3, destroyLabel);
+    ASSERT_TEST(strcmp(emGetNextEvent(em), "event4") == 0, destroyLabel);
+    ASSERT_TEST(emTick(em, 30) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emGetEventsAmount(em) == 0 && emGetNextEvent(em) == NULL, destroyLabel);
+
+destroyLabel:
+    destroyEventManager(em);
+destroyDateLabel:
+    dateDestroy(new_date);
+    dateDestroy(date);
+    return result;
+}
+
+static bool testEMMembers() {
+    bool result = true;
+    Date date = dateCreate(1, 1, 2020);
+    ASSERT_TEST(date != NULL, returnLabel);
+    EventManager em = createEventManager(date);
+    ASSERT_TEST(em != NULL, destroyDateLabel);
+    ASSERT_TEST(emAddMember(em, "alice", 1) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddMember(em, "bob", 2) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddMember(em, "carol", 1) == EM_MEMBER_ID_ALREADY_EXISTS, destroyLabel);
+    ASSERT_TEST(emAddMember(em, "dave", -1) == EM_INVALID_MEMBER_ID, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "meeting", 1, 1) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddEventByDiff(em, "party", 2, 2) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 1) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 1) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 2) == EM_SUCCESS, destroyLabel);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 2) == EM_EVENT_AND_MEMBER_ALREADY_LINKED, destroyLabel);
+    ASSERT_TEST(emAddMemberToEvent(em, 3, 2) == EM_MEMBER_ID_NOT_EXISTS, destroyLabel);
+    ASSERT_TEST(emRemoveMemberFromEvent(em, 1, 2) == EM_EVENT_AND_MEMBER_NOT_LINKED, destroyLabel);
+    emPrintAllEvents(em, EVENTS_FILE);
+    ASSERT_TEST(fileEquals(EVENTS_FILE, "meeting,2.1.2020,alice,bob\nparty,3.1.2020,bob\n"), destroyLabel);
+    emPrintAllResponsibleMembers(em, MEMBERS_FILE);
+    ASSERT_TEST(fileEquals(MEMBERS_FILE, "bob,2\nalice,1\n"), destroyLabel);
+    ASSERT_TEST(emRemoveMemberFromEvent(em, 2, 2) == EM_SUCCESS, destroyLabel);
+    emPrintAllResponsibleMembers(em, MEMBERS_FILE);
+    ASSERT_TEST(fileEquals(MEMBERS_FILE, "alice,1\nbob,1\n"), destroyLabel);
+
+destroyLabel:
+    destroyEventManager(em);
+destroyDateLabel:
+    dateDestroy(date);
+returnLabel:
+    return result;
+}
+
+int main() {
+    int failures = 0;
+    RUN_TEST(testEMCreateDestroy, "testEMCreateDestroy");
+    RUN_TEST(testEMAddAndRemoveEvents, "testEMAddAndRemoveEvents");
+    RUN_TEST(testEMChangeDateAndTick, "testEMChangeDateAndTick");
+    RUN_TEST(testEMMembers, "testEMMembers");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,1077 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "test_utilities.h"
+#include "../priority_queue.h"
+#include "../priority_queue_typed.h"
+
+#define ELEMENTS 1000
+#define STRESS_THREADS 4
+#define STRESS_ELEMENTS 20000
+
+/**
+ * Tests of the priority queue library. The elements are ints, and the priorities are ints where a greater value is a
+ * higher priority, except in scalar queues where a lower PQScalarPriority is a higher priority. The tests that go over
+ * every backend run the same checks on each of them.
+ */
+
+static const PQBackend backends[] = {PQ_BACKEND_LIST, PQ_BACKEND_HEAP};
+static const PQBackend scalar_backends[] = {PQ_BACKEND_LIST, PQ_BACKEND_HEAP, PQ_BACKEND_RADIX, PQ_BACKEND_WHEEL,
+                                            PQ_BACKEND_ARRAY};
+
+#define BACKENDS ((int) (sizeof(backends) / sizeof(*backends)))
+#define SCALAR_BACKENDS ((int) (sizeof(scalar_backends) / sizeof(*scalar_backends)))
+
+static int freed_elements = 0;
+
+static PQElement copyInt(PQElement element) {
+    int *copy = malloc(sizeof(*copy));
+    if (copy == NULL) {
+        return NULL;
+    }
+    *copy = *(int *) element;
+    return copy;
+}
+
+static void freeInt(PQElement element) {
+    freed_elements = freed_elements + 1;
+    free(element);
+}
+
+static bool equalInts(PQElement first, PQElement second) {
+    return *(int *) first == *(int *) second;
+}
+
+static int compareInts(PQElementPriority first, PQElementPriority second) {
+    return *(int *) first - *(int *) second;
+}
+
+/**
+ * freeUncounted: Frees an element without counting it, for queues shared between threads
+ */
+static void freeUncounted(PQElement element) {
+    free(element);
+}
+
+static unsigned long hashInt(PQElement element) {
+    return (unsigned long) *(int *) element * 2654435761UL;
+}
+
+static int compareTypedInts(int first, int second) {
+    return first - second;
+}
+
+static bool equalTypedInts(const int *first, const int *second) {
+    return *first == *second;
+}
+
+/** An element of a typed queue that owns memory, so it is copied and freed by the hooks of the queue */
+typedef int *IntBox;
+
+static bool copyBox(IntBox *destination, const IntBox *source) {
+    *destination = copyInt(*source);
+    return *destination != NULL;
+}
+
+static void freeBox(IntBox *element) {
+    freeInt(*element);
+}
+
+static bool equalBoxes(const IntBox *first, const IntBox *second) {
+    return **first == **second;
+}
+
+PQ_DEFINE(TypedInts, int, int, compareTypedInts, equalTypedInts);
+PQ_DEFINE(TypedBoxes, IntBox, int, compareTypedInts, equalBoxes);
+
+static PriorityQueue createIntQueue(PQBackend backend) {
+    return pqCreateWithBackend(backend, copyInt, freeInt, equalInts, copyInt, freeInt, compareInts);
+}
+
+static PriorityQueue createScalarQueue(PQBackend backend) {
+    return pqCreateScalar(backend, copyInt, freeInt, equalInts, NULL);
+}
+
+/**
+ * iteratesInOrder: Checks that walking queue with its internal iterator gives exactly the elements of expected
+ */
+static bool iteratesInOrder(PriorityQueue queue, const int *expected, int count) {
+    int i = 0;
+    PQ_FOREACH(int *, element, queue) {
+        if (i >= count || *element != expected[i]) {
+            return false;
+        }
+        i = i + 1;
+    }
+    return i == count;
+}
+
+/**
+ * removesInOrder: Checks that removing the first element of queue until it is empty gives exactly the elements of
+ * expected
+ */
+static bool removesInOrder(PriorityQueue queue, const int *expected, int count) {
+    if (pqGetSize(queue) != count) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        PQElement first;
+        if (pqPeekTopK(queue, 1, &first) != 1 || *(int *) first != expected[i] || pqRemove(queue) != PQ_SUCCESS) {
+            return false;
+        }
+    }
+    return pqGetSize(queue) == 0;
+}
+
+static bool testPQCreateDestroy() {
+    bool result = true;
+    PriorityQueue queue = createIntQueue(PQ_BACKEND_LIST);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    ASSERT_TEST(pqGetSize(queue) == 0, destroyLabel);
+    ASSERT_TEST(pqGetFirst(queue) == NULL, destroyLabel);
+    ASSERT_TEST(pqCreate(NULL, freeInt, equalInts, copyInt, freeInt, compareInts) == NULL, destroyLabel);
+    ASSERT_TEST(createScalarQueue((PQBackend) 42) == NULL, destroyLabel);
+    ASSERT_TEST(pqGetSize(NULL) == -1, destroyLabel);
+    ASSERT_TEST(pqInsert(queue, NULL, NULL) == PQ_NULL_ARGUMENT, destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+    pqDestroy(NULL);
+returnLabel:
+    return result;
+}
+
+static bool testPQBackendsKeepOrder() {
+    bool result = true;
+    int priorities[] = {3, 7, 1, 7, 5, 3};
+    int expected[] = {1, 3, 4, 0, 5, 2};
+    for (int b = 0; b < BACKENDS; b++) {
+        PriorityQueue queue = createIntQueue(backends[b]);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        for (int i = 0; i < 6; i++) {
+            ASSERT_TEST(pqInsert(queue, &i, &priorities[i]) == PQ_SUCCESS, destroyLabel);
+        }
+        ASSERT_TEST(iteratesInOrder(queue, expected, 6), destroyLabel);
+        ASSERT_TEST(removesInOrder(queue, expected, 6), destroyLabel);
+        ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS, destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQChangePriorityByHandle() {
+    bool result = true;
+    for (int b = 0; b < BACKENDS; b++) {
+        PriorityQueue queue = createIntQueue(backends[b]);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        PQHandle handles[5];
+        for (int i = 0; i < 5; i++) {
+            ASSERT_TEST(pqInsertWithHandle(queue, &i, &i, &handles[i]) == PQ_SUCCESS, destroyLabel);
+        }
+        int raised = 10, lowered = -1;
+        ASSERT_TEST(pqChangePriorityByHandle(queue, handles[1], &raised) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(pqChangePriorityByHandle(queue, handles[4], &lowered) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(pqChangePriorityByHandle(queue, NULL, &lowered) == PQ_NULL_ARGUMENT, destroyLabel);
+        int expected[] = {1, 3, 2, 0, 4};
+        ASSERT_TEST(removesInOrder(queue, expected, 5), destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQIndexed() {
+    bool result = true;
+    for (int b = 0; b < BACKENDS; b++) {
+        PriorityQueue queue = pqCreateIndexed(backends[b], copyInt, freeInt, equalInts, copyInt, freeInt,
+                                              compareInts, hashInt);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        for (int i = 0; i < ELEMENTS; i++) {
+            ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+        }
+        int present = ELEMENTS / 2, missing = ELEMENTS, old_priority = ELEMENTS / 2, new_priority = ELEMENTS;
+        ASSERT_TEST(pqContains(queue, &present), destroyLabel);
+        ASSERT_TEST(pqContains(queue, &missing) == false, destroyLabel);
+        ASSERT_TEST(pqChangePriority(queue, &present, &new_priority, &new_priority) == PQ_ELEMENT_DOES_NOT_EXISTS,
+                    destroyLabel);
+        ASSERT_TEST(pqChangePriority(queue, &present, &old_priority, &new_priority) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(*(int *) pqGetFirst(queue) == present, destroyLabel);
+        ASSERT_TEST(pqRemoveElement(queue, &present) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(pqRemoveElement(queue, &present) == PQ_ELEMENT_DOES_NOT_EXISTS, destroyLabel);
+        ASSERT_TEST(pqContains(queue, &present) == false, destroyLabel);
+        ASSERT_TEST(pqGetSize(queue) == ELEMENTS - 1, destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQExternalIterators() {
+    bool result = true;
+    PQIterator first = NULL, second = NULL;
+    PriorityQueue queue = createIntQueue(PQ_BACKEND_HEAP);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    first = pqIteratorCreate(queue);
+    second = pqIteratorCreate(queue);
+    ASSERT_TEST(first != NULL && second != NULL, destroyLabel);
+    ASSERT_TEST(*(int *) pqIteratorFirst(first) == 9, destroyLabel);
+    ASSERT_TEST(*(int *) pqIteratorNext(first) == 8, destroyLabel);
+    ASSERT_TEST(*(int *) pqIteratorFirst(second) == 9, destroyLabel);
+    ASSERT_TEST(*(int *) pqGetFirst(queue) == 9, destroyLabel);
+    ASSERT_TEST(*(int *) pqIteratorNext(first) == 7, destroyLabel);
+    int count = 0;
+    PQ_ITERATOR_FOREACH(int *, element, second) {
+        ASSERT_TEST(*element == 9 - count, destroyLabel);
+        count = count + 1;
+    }
+    ASSERT_TEST(count == 10, destroyLabel);
+    ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqIteratorNext(first) == NULL, destroyLabel);
+
+destroyLabel:
+    pqIteratorDestroy(first);
+    pqIteratorDestroy(second);
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+static bool testPQManyElements() {
+    bool result = true;
+    for (int b = 0; b < BACKENDS; b++) {
+        PriorityQueue queue = createIntQueue(backends[b]);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < ELEMENTS; i++) {
+                int priority = (i * 7919) % ELEMENTS;
+                ASSERT_TEST(pqInsert(queue, &i, &priority) == PQ_SUCCESS, destroyLabel);
+            }
+            int last = ELEMENTS;
+            for (int i = 0; i < ELEMENTS; i++) {
+                int *first = pqGetFirst(queue);
+                ASSERT_TEST(first != NULL && (*first * 7919) % ELEMENTS < last, destroyLabel);
+                last = (*first * 7919) % ELEMENTS;
+                ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS, destroyLabel);
+            }
+            ASSERT_TEST(pqGetSize(queue) == 0, destroyLabel);
+        }
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQScalarBackends() {
+    bool result = true;
+    PQScalarPriority priorities[] = {30, 10, 20, 10, 40, 30};
+    int expected[] = {1, 3, 2, 0, 5, 4};
+    for (int b = 0; b < SCALAR_BACKENDS; b++) {
+        PriorityQueue queue = createScalarQueue(scalar_backends[b]);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        for (int i = 0; i < 6; i++) {
+            ASSERT_TEST(pqInsert(queue, &i, &priorities[i]) == PQ_SUCCESS, destroyLabel);
+        }
+        ASSERT_TEST(iteratesInOrder(queue, expected, 6), destroyLabel);
+        int element = 4;
+        PQScalarPriority new_priority = 5;
+        ASSERT_TEST(pqChangePriority(queue, &element, &priorities[4], &new_priority) == PQ_SUCCESS, destroyLabel);
+        int changed[] = {4, 1, 3, 2, 0, 5};
+        ASSERT_TEST(removesInOrder(queue, changed, 6), destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQInsertTake() {
+    bool result = true;
+    PriorityQueue queue = createIntQueue(PQ_BACKEND_LIST);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    int value = 3;
+    int *element = copyInt(&value), *priority = copyInt(&value);
+    ASSERT_TEST(element != NULL && priority != NULL, destroyLabel);
+    ASSERT_TEST(pqInsertTake(queue, element, priority) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqGetFirst(queue) == element, destroyLabel);
+    freed_elements = 0;
+    ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(freed_elements == 2, destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+static bool testPQBatchAndFromArray() {
+    bool result = true;
+    int values[] = {4, 1, 3, 1, 5};
+    PQElement elements[5];
+    PQElementPriority priorities[5];
+    for (int i = 0; i < 5; i++) {
+        elements[i] = &values[i];
+        priorities[i] = &values[i];
+    }
+    int expected[] = {5, 4, 3, 1, 1};
+    for (int b = 0; b < BACKENDS; b++) {
+        PriorityQueue built = pqCreateFromArray(backends[b], copyInt, freeInt, equalInts, copyInt, freeInt,
+                                                compareInts, elements, priorities, 5);
+        PriorityQueue batched = createIntQueue(backends[b]);
+        ASSERT_TEST(built != NULL && batched != NULL, destroyLabel);
+        ASSERT_TEST(pqInsertBatch(batched, elements, priorities, 5) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(pqInsertBatch(batched, elements, priorities, -1) == PQ_ERROR, destroyLabel);
+        ASSERT_TEST(removesInOrder(built, expected, 5), destroyLabel);
+        ASSERT_TEST(removesInOrder(batched, expected, 5), destroyLabel);
+destroyLabel:
+        pqDestroy(built);
+        pqDestroy(batched);
+        if (result == false) {
+            break;
+        }
+    }
+    return result;
+}
+
+static bool testPQCopyOnWrite() {
+    bool result = true;
+    PriorityQueue copy = NULL;
+    PQIterator iterator = NULL;
+    PriorityQueue queue = createIntQueue(PQ_BACKEND_HEAP);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    copy = pqCopy(queue);
+    ASSERT_TEST(copy != NULL, destroyLabel);
+    iterator = pqIteratorCreate(copy);
+    ASSERT_TEST(iterator != NULL && *(int *) pqIteratorFirst(iterator) == 4, destroyLabel);
+    int missing = 42;
+    ASSERT_TEST(pqRemoveElement(queue, &missing) == PQ_ELEMENT_DOES_NOT_EXISTS, destroyLabel);
+    ASSERT_TEST(pqChangePriority(queue, &missing, &missing, &missing) == PQ_ELEMENT_DOES_NOT_EXISTS, destroyLabel);
+    ASSERT_TEST(pqIteratorNext(iterator) != NULL, destroyLabel);
+    int element = 10;
+    ASSERT_TEST(pqInsert(copy, &element, &element) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS, destroyLabel);
+    int queue_expected[] = {3, 2, 1, 0};
+    int copy_expected[] = {10, 4, 3, 2, 1, 0};
+    ASSERT_TEST(iteratesInOrder(queue, queue_expected, 4), destroyLabel);
+    ASSERT_TEST(iteratesInOrder(copy, copy_expected, 6), destroyLabel);
+
+destroyLabel:
+    pqIteratorDestroy(iterator);
+    pqDestroy(copy);
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+static bool testPQClearAndTrivialDestruction() {
+    bool result = true;
+    PriorityQueue queue = createIntQueue(PQ_BACKEND_LIST);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    freed_elements = 0;
+    ASSERT_TEST(pqClear(queue) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqGetSize(queue) == 0 && freed_elements == 20, destroyLabel);
+    int value = 1;
+    ASSERT_TEST(pqInsert(queue, &value, &value) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqSetTrivialDestruction(queue, true) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS && freed_elements == 22, destroyLabel);
+    ASSERT_TEST(pqSetTrivialDestruction(NULL, true) == PQ_NULL_ARGUMENT, destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+static bool testPQPeekTopKAndPopMany() {
+    bool result = true;
+    for (int b = 0; b < SCALAR_BACKENDS; b++) {
+        PriorityQueue queue = createScalarQueue(scalar_backends[b]);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        for (int i = 0; i < 10; i++) {
+            PQScalarPriority priority = 9 - i;
+            ASSERT_TEST(pqInsert(queue, &i, &priority) == PQ_SUCCESS, destroyLabel);
+        }
+        PQElement out[12];
+        ASSERT_TEST(pqPeekTopK(queue, 3, out) == 3, destroyLabel);
+        ASSERT_TEST(*(int *) out[0] == 9 && *(int *) out[1] == 8 && *(int *) out[2] == 7, destroyLabel);
+        ASSERT_TEST(pqPeekTopK(queue, -1, out) == -1, destroyLabel);
+        ASSERT_TEST(pqPopMany(queue, 2, out) == 2, destroyLabel);
+        bool popped = *(int *) out[0] == 9 && *(int *) out[1] == 8;
+        freeInt(out[0]);
+        freeInt(out[1]);
+        ASSERT_TEST(popped, destroyLabel);
+        ASSERT_TEST(pqPopMany(queue, 12, out) == 8, destroyLabel);
+        for (int i = 0; i < 8; i++) {
+            popped = popped && *(int *) out[i] == 7 - i;
+            freeInt(out[i]);
+        }
+        ASSERT_TEST(popped && pqGetSize(queue) == 0, destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQMerge() {
+    bool result = true;
+    for (int b = 0; b < BACKENDS; b++) {
+        PriorityQueue destination = createIntQueue(PQ_BACKEND_LIST);
+        PriorityQueue source = createIntQueue(backends[b]);
+        ASSERT_TEST(destination != NULL && source != NULL, destroyLabel);
+        for (int i = 0; i < 4; i++) {
+            int priority = i % 2;
+            int other = i + 10;
+            ASSERT_TEST(pqInsert(destination, &i, &priority) == PQ_SUCCESS, destroyLabel);
+            ASSERT_TEST(pqInsert(source, &other, &priority) == PQ_SUCCESS, destroyLabel);
+        }
+        ASSERT_TEST(pqMerge(destination, destination) == PQ_ERROR, destroyLabel);
+        ASSERT_TEST(pqMerge(destination, source) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(pqGetSize(source) == 0, destroyLabel);
+        int expected[] = {1, 3, 11, 13, 0, 2, 10, 12};
+        ASSERT_TEST(removesInOrder(destination, expected, 8), destroyLabel);
+destroyLabel:
+        pqDestroy(destination);
+        pqDestroy(source);
+        if (result == false) {
+            break;
+        }
+    }
+    return result;
+}
+
+static bool testPQConcurrent() {
+    bool result = true;
+    PriorityQueue copy = NULL;
+    PriorityQueue queue = pqCreateConcurrent(PQ_BACKEND_HEAP, copyInt, freeInt, equalInts, copyInt, freeInt,
+                                             compareInts);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    copy = pqCopy(queue);
+    ASSERT_TEST(copy != NULL, destroyLabel);
+    int expected[] = {4, 3, 2, 1, 0};
+    ASSERT_TEST(removesInOrder(queue, expected, 5), destroyLabel);
+    ASSERT_TEST(iteratesInOrder(copy, expected, 5), destroyLabel);
+    PQHandle handle;
+    int first = 1, second = 2, raised = 3;
+    ASSERT_TEST(pqInsertWithHandle(queue, &first, &first, &handle) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqInsert(queue, &second, &second) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqChangePriorityByHandle(queue, handle, &raised) == PQ_SUCCESS, destroyLabel);
+    int expected_handle[] = {1, 2};
+    ASSERT_TEST(removesInOrder(queue, expected_handle, 2), destroyLabel);
+    int lazy = 7, eager = 5;
+    ASSERT_TEST(pqSetLazyDeletion(copy, 0.5) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqRemoveElement(copy, &second) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqInsert(copy, &lazy, &lazy) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqSetLazyDeletion(copy, 0) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqInsert(copy, &eager, &eager) == PQ_SUCCESS, destroyLabel);
+    int expected_lazy[] = {7, 5, 4, 3, 1, 0};
+    ASSERT_TEST(removesInOrder(copy, expected_lazy, 6), destroyLabel);
+
+destroyLabel:
+    pqDestroy(copy);
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+/**
+ * Struct of the work of one thread of testPQConcurrentStress: the elements it popped in order, and whether it saw
+ * anything wrong
+ */
+typedef struct {
+    PriorityQueue queue;
+    int thread;
+    int *popped;
+    int popped_count;
+    bool failed;
+} StressThread;
+
+/**
+ * stressPop: Pops the first element of the queue of a stress thread and records it
+ * @return
+ *      false if the queue was empty
+ *      true otherwise
+ */
+static bool stressPop(StressThread *stress) {
+    PQElement element;
+    int count = pqPopMany(stress->queue, 1, &element);
+    if (count != 1) {
+        stress->failed = stress->failed || count != 0;
+        return false;
+    }
+    stress->popped[stress->popped_count] = *(int *) element;
+    stress->popped_count = stress->popped_count + 1;
+    free(element);
+    return true;
+}
+
+/**
+ * stressMixed: Inserts STRESS_ELEMENTS elements of its own into the queue, a quarter of them with pqInsertTake,
+ * popping one element after about every other insert and checking a random element now and then, while the other
+ * threads do the same
+ */
+static void *stressMixed(void *argument) {
+    StressThread *stress = argument;
+    unsigned long random = 88172645463325252UL + (unsigned long) stress->thread;
+    for (int i = 0; i < STRESS_ELEMENTS; i++) {
+        int element = stress->thread * STRESS_ELEMENTS + i;
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        PriorityQueueResult inserted;
+        if ((random >> 8) % 4 == 3) {
+            int *taken = malloc(sizeof(*taken)), *priority = malloc(sizeof(*priority));
+            if (taken == NULL || priority == NULL) {
+                free(taken);
+                free(priority);
+                stress->failed = true;
+                return NULL;
+            }
+            *taken = element;
+            *priority = element;
+            inserted = pqInsertTake(stress->queue, taken, priority);
+        } else {
+            inserted = pqInsert(stress->queue, &element, &element);
+        }
+        if (inserted != PQ_SUCCESS) {
+            stress->failed = true;
+            return NULL;
+        }
+        if (random % 2 == 0) {
+            stressPop(stress);
+        }
+        if (random % 64 == 1) {
+            pqContains(stress->queue, &element);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * stressDrain: Pops elements until the queue is empty, while the other threads do the same. With no inserts left,
+ * the elements each thread pops must come in order of priority
+ */
+static void *stressDrain(void *argument) {
+    StressThread *stress = argument;
+    int start = stress->popped_count;
+    while (stressPop(stress)) {
+        int last = stress->popped_count - 1;
+        if (last > start && stress->popped[last] >= stress->popped[last - 1]) {
+            stress->failed = true;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * stressRun: Runs a function in STRESS_THREADS threads at once and waits for all of them
+ */
+static bool stressRun(StressThread *stress, void *(*function)(void *)) {
+    pthread_t threads[STRESS_THREADS];
+    int started = 0;
+    for (; started < STRESS_THREADS; started++) {
+        if (pthread_create(&threads[started], NULL, function, &stress[started]) != 0) {
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return started == STRESS_THREADS;
+}
+
+static bool testPQConcurrentStress() {
+    bool result = true;
+    StressThread stress[STRESS_THREADS];
+    int *seen = calloc(STRESS_THREADS * STRESS_ELEMENTS, sizeof(*seen));
+    PriorityQueue queue = pqCreateConcurrent(PQ_BACKEND_HEAP, copyInt, freeUncounted, equalInts, copyInt,
+                                             freeUncounted, compareInts);
+    int threads = 0;
+    ASSERT_TEST(seen != NULL && queue != NULL, destroyLabel);
+    for (; threads < STRESS_THREADS; threads++) {
+        stress[threads].queue = queue;
+        stress[threads].thread = threads;
+        stress[threads].popped = malloc(sizeof(int) * STRESS_THREADS * STRESS_ELEMENTS);
+        stress[threads].popped_count = 0;
+        stress[threads].failed = false;
+        ASSERT_TEST(stress[threads].popped != NULL, destroyLabel);
+    }
+    ASSERT_TEST(stressRun(stress, stressMixed), destroyLabel);
+    ASSERT_TEST(stressRun(stress, stressDrain), destroyLabel);
+    ASSERT_TEST(pqGetSize(queue) == 0, destroyLabel);
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        ASSERT_TEST(stress[i].failed == false, destroyLabel);
+        for (int j = 0; j < stress[i].popped_count; j++) {
+            int element = stress[i].popped[j];
+            ASSERT_TEST(element >= 0 && element < STRESS_THREADS * STRESS_ELEMENTS, destroyLabel);
+            seen[element] = seen[element] + 1;
+        }
+    }
+    for (int element = 0; element < STRESS_THREADS * STRESS_ELEMENTS; element++) {
+        ASSERT_TEST(seen[element] == 1, destroyLabel);
+    }
+
+destroyLabel:
+    for (int i = 0; i < threads; i++) {
+        free(stress[i].popped);
+    }
+    pqDestroy(queue);
+    free(seen);
+    return result;
+}
+
+static bool testPQRelaxed() {
+    bool result = true;
+    PriorityQueue queue = pqCreateRelaxed(2, 2, copyInt, freeInt, equalInts, copyInt, freeInt, compareInts);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    ASSERT_TEST(pqCreateRelaxed(0, 2, copyInt, freeInt, equalInts, copyInt, freeInt, compareInts) == NULL,
+                destroyLabel);
+    for (int i = 0; i < ELEMENTS; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(pqGetSize(queue) == ELEMENTS, destroyLabel);
+    ASSERT_TEST(pqGetFirst(queue) == NULL && pqCopy(queue) == NULL, destroyLabel);
+    int element = 7;
+    ASSERT_TEST(pqContains(queue, &element), destroyLabel);
+    ASSERT_TEST(pqRemoveElement(queue, &element) == PQ_SUCCESS, destroyLabel);
+    bool seen[ELEMENTS] = {false};
+    seen[element] = true;
+    for (int i = 0; i < ELEMENTS - 1; i++) {
+        PQElement popped;
+        ASSERT_TEST(pqPopMany(queue, 1, &popped) == 1, destroyLabel);
+        bool repeated = seen[*(int *) popped];
+        seen[*(int *) popped] = true;
+        freeInt(popped);
+        ASSERT_TEST(repeated == false, destroyLabel);
+    }
+    ASSERT_TEST(pqGetSize(queue) == 0, destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+static bool testPQBuffered() {
+    bool result = true;
+    PQStats stats;
+    PriorityQueue queue = pqCreateBuffered(PQ_BACKEND_HEAP, PQ_FLUSH_WHEN_FULL, 4, copyInt, freeInt, equalInts,
+                                           copyInt, freeInt, compareInts);
+    PriorityQueue on_read = pqCreateBuffered(PQ_BACKEND_LIST, PQ_FLUSH_ON_READ, 4, copyInt, freeInt, equalInts,
+                                             copyInt, freeInt, compareInts);
+    ASSERT_TEST(queue != NULL && on_read != NULL, destroyLabel);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(pqInsert(on_read, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(pqGetSize(queue) == 0 && pqGetSize(on_read) == 3, destroyLabel);
+    ASSERT_TEST(pqGetStats(queue, &stats) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(stats.buffer_size == 4 && stats.buffered == 3, destroyLabel);
+    ASSERT_TEST(pqFlush(queue) == PQ_SUCCESS && pqGetSize(queue) == 3, destroyLabel);
+    for (int i = 3; i < 7; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(pqGetSize(queue) == 7, destroyLabel);
+    int expected[] = {6, 5, 4, 3, 2, 1, 0};
+    ASSERT_TEST(removesInOrder(queue, expected, 7), destroyLabel);
+    ASSERT_TEST(removesInOrder(on_read, expected + 4, 3), destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+    pqDestroy(on_read);
+    return result;
+}
+
+static bool testPQBounded() {
+    bool result = true;
+    for (int b = 0; b < BACKENDS; b++) {
+        PriorityQueue queue = pqCreateBounded(backends[b], 4, sizeof(int), sizeof(int), equalInts, compareInts);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+        }
+        int element = 4;
+        ASSERT_TEST(pqInsert(queue, &element, &element) == PQ_FULL, destroyLabel);
+        ASSERT_TEST(pqInsertTake(queue, &element, &element) == PQ_ERROR, destroyLabel);
+        ASSERT_TEST(pqSetLazyDeletion(queue, 0.5) == PQ_ERROR, destroyLabel);
+        element = 1;
+        ASSERT_TEST(pqRemoveElement(queue, &element) == PQ_SUCCESS, destroyLabel);
+        element = 9;
+        ASSERT_TEST(pqInsert(queue, &element, &element) == PQ_SUCCESS, destroyLabel);
+        int expected[] = {9, 3, 2, 0};
+        ASSERT_TEST(removesInOrder(queue, expected, 4), destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQBuckets() {
+    bool result = true;
+    PQBackend bucket_backends[] = {PQ_BACKEND_RADIX, PQ_BACKEND_WHEEL};
+    for (int b = 0; b < 2; b++) {
+        PQStats stats;
+        PriorityQueue queue = createScalarQueue(bucket_backends[b]);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        PQScalarPriority priorities[] = {5, 100, 70000, 5, 64, 1000000};
+        for (int i = 0; i < 6; i++) {
+            ASSERT_TEST(pqInsert(queue, &i, &priorities[i]) == PQ_SUCCESS, destroyLabel);
+        }
+        ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS && pqRemove(queue) == PQ_SUCCESS, destroyLabel);
+        int element = 6;
+        PQScalarPriority earlier = 1;
+        ASSERT_TEST(pqInsert(queue, &element, &earlier) == PQ_SUCCESS, destroyLabel);
+        ASSERT_TEST(pqGetStats(queue, &stats) == PQ_SUCCESS && stats.rebuilds == 1, destroyLabel);
+        int expected[] = {6, 4, 1, 2, 5};
+        ASSERT_TEST(iteratesInOrder(queue, expected, 5), destroyLabel);
+        ASSERT_TEST(removesInOrder(queue, expected, 5), destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+/**
+ * wheelPriority: The priority testPQWheelWalk gives an element, many elements share each priority
+ */
+static PQScalarPriority wheelPriority(int element) {
+    return element < ELEMENTS ? (element * 7919) % (ELEMENTS / 2) : 2 * ELEMENTS - element;
+}
+
+/**
+ * walksWheelInOrder: Checks that walking a queue of testPQWheelWalk with an external iterator gives count elements
+ * in the order of their priorities, elements of equal priority in the order they were inserted
+ */
+static bool walksWheelInOrder(PriorityQueue queue, int count) {
+    PQIterator iterator = pqIteratorCreate(queue);
+    if (iterator == NULL) {
+        return false;
+    }
+    int walked = 0, previous = -1;
+    PQ_ITERATOR_FOREACH(int *, element, iterator) {
+        if (previous >= 0 && (wheelPriority(previous) > wheelPriority(*element) ||
+                              (wheelPriority(previous) == wheelPriority(*element) && previous > *element))) {
+            break;
+        }
+        previous = *element;
+        walked = walked + 1;
+    }
+    pqIteratorDestroy(iterator);
+    return walked == count;
+}
+
+static bool testPQWheelWalk() {
+    bool result = true;
+    PriorityQueue queue = createScalarQueue(PQ_BACKEND_WHEEL);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    for (int i = 0; i < ELEMENTS; i++) {
+        PQScalarPriority priority = wheelPriority(i);
+        ASSERT_TEST(pqInsert(queue, &i, &priority) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(walksWheelInOrder(queue, ELEMENTS) && walksWheelInOrder(queue, ELEMENTS), destroyLabel);
+    for (int i = ELEMENTS; i < ELEMENTS + ELEMENTS / 10; i++) {
+        PQScalarPriority priority = wheelPriority(i);
+        ASSERT_TEST(pqInsert(queue, &i, &priority) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(walksWheelInOrder(queue, ELEMENTS + ELEMENTS / 10), destroyLabel);
+    ASSERT_TEST(pqSetLazyDeletion(queue, 0.5) == PQ_SUCCESS, destroyLabel);
+    for (int i = 0; i < ELEMENTS; i = i + 3) {
+        ASSERT_TEST(pqRemoveElement(queue, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(walksWheelInOrder(queue, ELEMENTS + ELEMENTS / 10 - (ELEMENTS + 2) / 3), destroyLabel);
+    PQElement top[3];
+    ASSERT_TEST(pqPeekTopK(queue, 3, top) == 3, destroyLabel);
+    ASSERT_TEST(*(int *) top[0] == 500 && *(int *) top[1] == 179 && *(int *) top[2] == 679, destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+static bool testPQArray() {
+    bool result = true;
+    PriorityQueue queue = createScalarQueue(PQ_BACKEND_ARRAY);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    PQHandle handles[ELEMENTS];
+    for (int i = 0; i < ELEMENTS; i++) {
+        PQScalarPriority priority = (i * 7919) % ELEMENTS;
+        ASSERT_TEST(pqInsertWithHandle(queue, &i, &priority, &handles[i]) == PQ_SUCCESS, destroyLabel);
+    }
+    for (int i = 0; i < ELEMENTS; i = i + 2) {
+        PQScalarPriority priority = ELEMENTS + i;
+        ASSERT_TEST(pqChangePriorityByHandle(queue, handles[i], &priority) == PQ_SUCCESS, destroyLabel);
+    }
+    int element = 3;
+    PQScalarPriority old_priority = (3 * 7919) % ELEMENTS, new_priority = -1;
+    ASSERT_TEST(pqChangePriority(queue, &element, &old_priority, &new_priority) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(*(int *) pqGetFirst(queue) == 3, destroyLabel);
+    element = 5;
+    ASSERT_TEST(pqRemoveElement(queue, &element) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqContains(queue, &element) == false, destroyLabel);
+    ASSERT_TEST(pqRemove(queue) == PQ_SUCCESS, destroyLabel);
+    PQScalarPriority last = -1;
+    int count = 0;
+    PQ_FOREACH(int *, current, queue) {
+        PQScalarPriority priority = *current % 2 == 0 ? ELEMENTS + *current : (*current * 7919) % ELEMENTS;
+        ASSERT_TEST(priority > last, destroyLabel);
+        last = priority;
+        count = count + 1;
+    }
+    ASSERT_TEST(count == ELEMENTS - 2, destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+/**
+ * isMultipleOf: A predicate for pqRemoveIf that doesn't follow the order of the queue, matching the elements that are
+ * multiples of *divisor
+ */
+static bool isMultipleOf(PQElement element, void *divisor) {
+    return *(int *) element % *(int *) divisor == 0;
+}
+
+static bool testPQRemoveIf() {
+    bool result = true;
+    for (int b = 0; b < SCALAR_BACKENDS; b++) {
+        PriorityQueue queue = createScalarQueue(scalar_backends[b]);
+        ASSERT_TEST(queue != NULL, returnLabel);
+        for (int i = 0; i < 20; i++) {
+            PQScalarPriority priority = (i * 7) % 20;
+            ASSERT_TEST(pqInsert(queue, &i, &priority) == PQ_SUCCESS, destroyLabel);
+        }
+        int divisor = 3;
+        ASSERT_TEST(pqRemoveIf(queue, NULL, &divisor) == -1, destroyLabel);
+        freed_elements = 0;
+        ASSERT_TEST(pqRemoveIf(queue, isMultipleOf, &divisor) == 7 && freed_elements == 7, destroyLabel);
+        divisor = 21;
+        ASSERT_TEST(pqRemoveIf(queue, isMultipleOf, &divisor) == 0, destroyLabel);
+        int expected[] = {1, 4, 7, 10, 13, 16, 19, 2, 5, 8, 11, 14, 17};
+        ASSERT_TEST(iteratesInOrder(queue, expected, 13), destroyLabel);
+        ASSERT_TEST(removesInOrder(queue, expected, 13), destroyLabel);
+destroyLabel:
+        pqDestroy(queue);
+        if (result == false) {
+            break;
+        }
+    }
+returnLabel:
+    return result;
+}
+
+static bool testPQLazyDeletion() {
+    bool result = true;
+    PQStats stats;
+    PriorityQueue queue = pqCreateScalar(PQ_BACKEND_HEAP, copyInt, freeInt, equalInts, hashInt);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    ASSERT_TEST(pqSetLazyDeletion(queue, 1.5) == PQ_ERROR, destroyLabel);
+    ASSERT_TEST(pqSetLazyDeletion(queue, 0.45) == PQ_SUCCESS, destroyLabel);
+    for (int i = 0; i < 10; i++) {
+        PQScalarPriority priority = i;
+        ASSERT_TEST(pqInsert(queue, &i, &priority) == PQ_SUCCESS, destroyLabel);
+    }
+    for (int i = 0; i < 4; i++) {
+        int element = i * 2;
+        ASSERT_TEST(pqRemoveElement(queue, &element) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(pqGetStats(queue, &stats) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(stats.tombstones == 4 && stats.compactions == 0 && pqGetSize(queue) == 6, destroyLabel);
+    int element = 0;
+    ASSERT_TEST(pqContains(queue, &element) == false, destroyLabel);
+    int expected[] = {1, 3, 5, 7, 8, 9};
+    ASSERT_TEST(iteratesInOrder(queue, expected, 6), destroyLabel);
+    element = 8;
+    ASSERT_TEST(pqRemoveElement(queue, &element) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqGetStats(queue, &stats) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(stats.tombstones == 0 && stats.compactions == 1, destroyLabel);
+    int remaining[] = {1, 3, 5, 7, 9};
+    ASSERT_TEST(removesInOrder(queue, remaining, 5), destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+static bool testPQStats() {
+    bool result = true;
+    PQStats stats;
+    PriorityQueue queue = createIntQueue(PQ_BACKEND_LIST);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TEST(pqInsert(queue, &i, &i) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(pqGetStats(queue, NULL) == PQ_NULL_ARGUMENT, destroyLabel);
+    ASSERT_TEST(pqGetStats(queue, &stats) == PQ_SUCCESS, destroyLabel);
+#ifdef PQ_STATS
+    ASSERT_TEST(stats.counters.inserts == 10 && stats.counters.max_size == 10, destroyLabel);
+    ASSERT_TEST(stats.counters.copy_calls == 20 && stats.counters.comparisons > 0, destroyLabel);
+#else
+    ASSERT_TEST(stats.counters.inserts == 0 && stats.counters.comparisons == 0, destroyLabel);
+#endif
+    ASSERT_TEST(pqResetStats(queue) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(pqGetStats(queue, &stats) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(stats.counters.inserts == 0 && stats.counters.comparisons == 0, destroyLabel);
+
+destroyLabel:
+    pqDestroy(queue);
+returnLabel:
+    return result;
+}
+
+/**
+ * typedIteratesInOrder: Checks that walking a TypedInts queue with its iterator gives exactly the elements of expected
+ */
+static bool typedIteratesInOrder(TypedInts queue, const int *expected, int count) {
+    int i = 0;
+    PQ_TYPED_FOREACH(TypedInts, int *, element, queue) {
+        if (i >= count || *element != expected[i]) {
+            return false;
+        }
+        i = i + 1;
+    }
+    return i == count;
+}
+
+static bool testPQTyped() {
+    bool result = true;
+    int priorities[] = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3};
+    int expected[] = {5, 7, 4, 8, 2, 0, 9, 6, 1, 3};
+    int changed[] = {1, 5, 4, 8, 2, 0, 9, 6, 3};
+    int copied[] = {5, 4, 8, 2, 0, 9, 6, 3};
+    int count = (int) (sizeof(priorities) / sizeof(*priorities));
+    int missing = 42;
+    TypedInts copy = NULL;
+    TypedBoxes boxes = NULL;
+    TypedBoxes boxes_copy = NULL;
+    TypedInts queue = TypedIntsCreate(NULL, NULL);
+    ASSERT_TEST(queue != NULL, returnLabel);
+    ASSERT_TEST(TypedIntsInsert(NULL, &missing, 0) == PQ_NULL_ARGUMENT, destroyLabel);
+    ASSERT_TEST(TypedIntsGetFirst(queue) == NULL, destroyLabel);
+    for (int i = 0; i < count; i++) {
+        ASSERT_TEST(TypedIntsInsert(queue, &i, priorities[i]) == PQ_SUCCESS, destroyLabel);
+    }
+    ASSERT_TEST(TypedIntsGetSize(queue) == count, destroyLabel);
+    ASSERT_TEST(typedIteratesInOrder(queue, expected, count), destroyLabel);
+    ASSERT_TEST(TypedIntsContains(queue, &expected[3]) && !TypedIntsContains(queue, &missing), destroyLabel);
+    ASSERT_TEST(TypedIntsChangePriority(queue, &expected[8], 7, 10) == PQ_ELEMENT_DOES_NOT_EXISTS, destroyLabel);
+    ASSERT_TEST(TypedIntsChangePriority(queue, &expected[8], 1, 10) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(TypedIntsRemoveElement(queue, &expected[1]) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(TypedIntsRemoveElement(queue, &missing) == PQ_ELEMENT_DOES_NOT_EXISTS, destroyLabel);
+    ASSERT_TEST(typedIteratesInOrder(queue, changed, count - 1), destroyLabel);
+    ASSERT_TEST(TypedIntsRemove(queue) == PQ_SUCCESS, destroyLabel);
+    copy = TypedIntsCopy(queue);
+    ASSERT_TEST(copy != NULL && TypedIntsClear(queue) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(TypedIntsGetSize(queue) == 0 && TypedIntsGetFirst(queue) == NULL, destroyLabel);
+    ASSERT_TEST(typedIteratesInOrder(copy, copied, count - 2), destroyLabel);
+
+    for (int i = 0; i < ELEMENTS; i++) {
+        int priority = (i * 7) % (ELEMENTS / 10);
+        ASSERT_TEST(TypedIntsInsert(queue, &i, priority) == PQ_SUCCESS, destroyLabel);
+    }
+    int previous = ELEMENTS;
+    PQ_TYPED_FOREACH(TypedInts, int *, element, queue) {
+        int priority = (*element * 7) % (ELEMENTS / 10);
+        ASSERT_TEST(priority <= previous, destroyLabel);
+        previous = priority;
+    }
+
+    freed_elements = 0;
+    boxes = TypedBoxesCreate(copyBox, freeBox);
+    ASSERT_TEST(boxes != NULL, destroyLabel);
+    for (int i = 0; i < 3; i++) {
+        IntBox box = &i;
+        ASSERT_TEST(TypedBoxesInsert(boxes, &box, i) == PQ_SUCCESS, destroyLabel);
+    }
+    boxes_copy = TypedBoxesCopy(boxes);
+    ASSERT_TEST(boxes_copy != NULL && TypedBoxesRemove(boxes) == PQ_SUCCESS, destroyLabel);
+    ASSERT_TEST(freed_elements == 1 && **TypedBoxesGetFirst(boxes) == 1, destroyLabel);
+    ASSERT_TEST(**TypedBoxesGetFirst(boxes_copy) == 2, destroyLabel);
+    TypedBoxesDestroy(boxes);
+    boxes = NULL;
+    ASSERT_TEST(freed_elements == 3 && TypedBoxesGetSize(boxes_copy) == 3, destroyLabel);
+
+destroyLabel:
+    TypedBoxesDestroy(boxes_copy);
+    TypedBoxesDestroy(boxes);
+    TypedIntsDestroy(copy);
+    TypedIntsDestroy(queue);
+returnLabel:
+    return result;
+}
+
+int main() {
+    int failures = 0;
+    RUN_TEST(testPQCreateDestroy, "testPQCreateDestroy");
+    RUN_TEST(testPQBackendsKeepOrder, "testPQBackendsKeepOrder");
+    RUN_TEST(testPQChangePriorityByHandle, "testPQChangePriorityByHandle");
+    RUN_TEST(testPQIndexed, "testPQIndexed");
+    RUN_TEST(testPQExternalIterators, "testPQExternalIterators");
+    RUN_TEST(testPQManyElements, "testPQManyElements");
+    RUN_TEST(testPQScalarBackends, "testPQScalarBackends");
+    RUN_TEST(testPQInsertTake, "testPQInsertTake");
+    RUN_TEST(testPQBatchAndFromArray, "testPQBatchAndFromArray");
+    RUN_TEST(testPQCopyOnWrite, "testPQCopyOnWrite");
+    RUN_TEST(testPQClearAndTrivialDestruction, "testPQClearAndTrivialDestruction");
+    RUN_TEST(testPQPeekTopKAndPopMany, "testPQPeekTopKAndPopMany");
+    RUN_TEST(testPQMerge, "testPQMerge");
+    RUN_TEST(testPQConcurrent, "testPQConcurrent");
+    RUN_TEST(testPQConcurrentStress, "testPQConcurrentStress");
+    RUN_TEST(testPQRelaxed, "testPQRelaxed");
+    RUN_TEST(testPQBuffered, "testPQBuffered");
+    RUN_TEST(testPQBounded, "testPQBounded");
+    RUN_TEST(testPQBuckets, "testPQBuckets");
+    RUN_TEST(testPQWheelWalk, "testPQWheelWalk");
+    RUN_TEST(testPQArray, "testPQArray");
+    RUN_TEST(testPQRemoveIf, "testPQRemoveIf");
+    RUN_TEST(testPQLazyDeletion, "testPQLazyDeletion");
+    RUN_TEST(testPQStats, "testPQStats");
+    RUN_TEST(testPQTyped, "testPQTyped");
+    return failures == 0 ? 0 : 1;
+}
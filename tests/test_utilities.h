@@ -0,0 +1,49 @@
+#ifndef TEST_UTILITIES_H_
+#define TEST_UTILITIES_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * These macros are here to help you create tests more easily and keep them
+ * clear.
+ *
+ * The basic idea with unit-testing is create a test function for every real
+ * function and inside the test function declare some variables and execute the
+ * function under test.
+ *
+ * Use the ASSERT_TEST to verify correctness of values. A test function sets
+ * result to false and jumps to goto_label when an assertion fails, so the
+ * cleanup after the label still runs.
+ */
+
+/**
+ * Evaluates expr and continues if expr is true.
+ * If expr is false, ends the test by setting result to false, printing an
+ * error message and jumping to goto_label.
+ */
+#define ASSERT_TEST(expr, goto_label) \
+    do { \
+        if (!(expr)) { \
+            printf("\nAssertion failed at %s:%d %s ", __FILE__, __LINE__, #expr); \
+            result = false; \
+            goto goto_label; \
+        } \
+    } while (0)
+
+/**
+ * Macro used for running a test from the main function. Counts the failed
+ * tests in failures, which main returns.
+ */
+#define RUN_TEST(test, name) \
+    do { \
+        printf("Running %s ... ", name); \
+        if (test()) { \
+            printf("[OK]\n"); \
+        } else { \
+            printf("[Failed]\n"); \
+            failures = failures + 1; \
+        } \
+    } while (0)
+
+#endif /* TEST_UTILITIES_H_ */